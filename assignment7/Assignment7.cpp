@@ -54,7 +54,9 @@ std::shared_ptr<ColorSampler> Assignment7::CreateSampler() const
 
 std::shared_ptr<class Renderer> Assignment7::CreateRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) const
 {
-    return std::make_shared<PhotonMappingRenderer>(scene, sampler);
+    std::shared_ptr<PhotonMappingRenderer> renderer = std::make_shared<PhotonMappingRenderer>(scene, sampler);
+    renderer->SetNumberOfPhotonThreads(GetNumThreads());
+    return renderer;
 }
 
 bool Assignment7::NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex)
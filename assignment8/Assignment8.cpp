@@ -323,7 +323,11 @@ std::shared_ptr<ColorSampler> Assignment8::CreateSampler() const
 std::shared_ptr<class Renderer> Assignment8::CreateRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) const
 {
 //	return std::make_shared<BackwardRenderer>(scene, sampler);
-	return std::make_shared<PhotonMappingRenderer>(scene, sampler);
+//	return std::make_shared<ProgressivePhotonMappingRenderer>(scene, sampler);
+	std::shared_ptr<PhotonMappingRenderer> renderer = std::make_shared<PhotonMappingRenderer>(scene, sampler);
+	renderer->SetNumberOfPhotonThreads(GetNumThreads());
+	renderer->SetIrradianceCacheAccuracy(0.2f);
+	return renderer;
 }
 
 bool Assignment8::NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex)
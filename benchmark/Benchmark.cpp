@@ -0,0 +1,130 @@
+#include "benchmark/Benchmark.h"
+#include <chrono>
+#include <iomanip>
+
+BenchmarkSuite::BenchmarkSuite():
+    minimumTime(0.5), minimumIterations(3)
+{
+}
+
+void BenchmarkSuite::Add(const std::string& name, BenchmarkFactory factory)
+{
+    Entry entry;
+    entry.name = name;
+    entry.factory = std::move(factory);
+    benchmarks.push_back(std::move(entry));
+}
+
+void BenchmarkSuite::SetMinimumTime(double seconds)
+{
+    minimumTime = std::max(seconds, 0.0);
+}
+
+void BenchmarkSuite::SetMinimumIterations(int iterations)
+{
+    minimumIterations = std::max(iterations, 1);
+}
+
+void BenchmarkSuite::SetFilter(const std::string& input)
+{
+    filter = input;
+}
+
+bool BenchmarkSuite::PassesFilter(const std::string& name) const
+{
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void BenchmarkSuite::List(std::ostream& output) const
+{
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+        if (PassesFilter(benchmarks[i].name)) {
+            output << benchmarks[i].name << std::endl;
+        }
+    }
+}
+
+std::vector<BenchmarkResult> BenchmarkSuite::Run(std::ostream& progress, int& failedBenchmarks) const
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<BenchmarkResult> results;
+    failedBenchmarks = 0;
+    for (size_t i = 0; i < benchmarks.size(); ++i) {
+        const Entry& entry = benchmarks[i];
+        if (!PassesFilter(entry.name)) {
+            continue;
+        }
+
+        BenchmarkIteration iteration = entry.factory();
+        if (!iteration) {
+            std::cerr << "ERROR: Could not set up " << entry.name << "; skipping it." << std::endl;
+            ++failedBenchmarks;
+            continue;
+        }
+
+        BenchmarkResult result;
+        result.name = entry.name;
+        result.iterations = 0;
+        result.bestSeconds = std::numeric_limits<double>::max();
+        result.checksum = 0.0;
+
+        // The warm-up pays for first-touch page faults and lazily built caches. Its checksum is the one reported.
+        result.itemsPerIteration = iteration(result.checksum);
+
+        double totalSeconds = 0.0;
+        while (result.iterations < minimumIterations || totalSeconds < minimumTime) {
+            double checksum = 0.0;
+            const Clock::time_point start = Clock::now();
+            iteration(checksum);
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            totalSeconds += seconds;
+            result.bestSeconds = std::min(result.bestSeconds, seconds);
+            ++result.iterations;
+        }
+        result.meanSeconds = totalSeconds / result.iterations;
+
+        const double nsPerItem = result.itemsPerIteration ? 1e9 * result.bestSeconds / result.itemsPerIteration : 0.0;
+        progress << std::left << std::setw(56) << result.name << std::right << std::fixed << std::setprecision(3)
+                 << std::setw(12) << result.bestSeconds * 1e3 << " ms" << std::setw(12) << nsPerItem << " ns/item" << std::endl;
+        progress.unsetf(std::ios_base::floatfield);
+        results.push_back(result);
+    }
+    return results;
+}
+
+bool BenchmarkSuite::WriteJSON(const std::vector<BenchmarkResult>& results, const std::string& fileName)
+{
+    std::ofstream output(fileName);
+    if (!output) {
+        std::cerr << "ERROR: Could not write benchmark results to " << fileName << std::endl;
+        return false;
+    }
+
+    output << "{" << std::endl;
+    output << "  \"context\": {" << std::endl;
+    output << "    \"seed\": " << BENCHMARK_SEED << "," << std::endl;
+    output << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << "," << std::endl;
+#ifdef __AVX__
+    output << "    \"simd\": \"avx\"," << std::endl;
+#else
+    output << "    \"simd\": \"sse2\"," << std::endl;
+#endif
+    output << "    \"diagnostics\": " << DIAGNOSTICS_ON << std::endl;
+    output << "  }," << std::endl;
+    output << "  \"benchmarks\": [" << std::endl;
+    output << std::setprecision(17);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        const double items = static_cast<double>(result.itemsPerIteration);
+        output << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+               << ", \"items_per_iteration\": " << result.itemsPerIteration
+               << ", \"best_seconds\": " << result.bestSeconds << ", \"mean_seconds\": " << result.meanSeconds
+               << ", \"items_per_second\": " << (result.bestSeconds > 0.0 ? items / result.bestSeconds : 0.0)
+               << ", \"checksum\": " << result.checksum << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    output << "  ]" << std::endl;
+    output << "}" << std::endl;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common/common.h"
+
+struct BenchmarkResult
+{
+    std::string name;
+    int iterations;
+    uint64_t itemsPerIteration;
+    double bestSeconds;
+    double meanSeconds;
+    // Folded from whatever the benchmark computed. Identical inputs give identical checksums, so a changed checksum
+    // means the kernel's output changed, not just its speed.
+    double checksum;
+};
+
+class BenchmarkSuite
+{
+public:
+    // Runs one iteration and returns how many items (rays, queries, samples, pixels) it processed. Results should be
+    // folded into checksum so the work cannot be optimized away.
+    typedef std::function<uint64_t(double& checksum)> BenchmarkIteration;
+    // Builds the benchmark's inputs and returns the iteration to time, or an empty iteration if the inputs could not be
+    // built. Only called for benchmarks that pass the filter.
+    typedef std::function<BenchmarkIteration()> BenchmarkFactory;
+
+    BenchmarkSuite();
+
+    // Names are slash separated, e.g. "traversal/bvh/coherent/closest".
+    void Add(const std::string& name, BenchmarkFactory factory);
+
+    // Every benchmark runs for at least this long and at least this many iterations, after one untimed warm-up.
+    void SetMinimumTime(double seconds);
+    void SetMinimumIterations(int iterations);
+
+    // Only benchmarks whose name contains the filter run. Empty runs everything.
+    void SetFilter(const std::string& input);
+
+    void List(std::ostream& output) const;
+    // Benchmarks whose factory fails are reported, left out of the results and counted in failedBenchmarks.
+    std::vector<BenchmarkResult> Run(std::ostream& progress, int& failedBenchmarks) const;
+
+    static bool WriteJSON(const std::vector<BenchmarkResult>& results, const std::string& fileName);
+
+private:
+    struct Entry
+    {
+        std::string name;
+        BenchmarkFactory factory;
+    };
+
+    bool PassesFilter(const std::string& name) const;
+
+    std::vector<Entry> benchmarks;
+    double minimumTime;
+    int minimumIterations;
+    std::string filter;
+};
+
+// Fixed seed for every benchmark input, so runs on different revisions trace exactly the same rays.
+const uint64_t BENCHMARK_SEED = 148;
+
+void RegisterKernelBenchmarks(BenchmarkSuite& suite);
+void RegisterRenderBenchmarks(BenchmarkSuite& suite, int numThreads, const std::string& outputDirectory);
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "benchmark/BenchmarkApplication.h"
+#include "common/core.h"
+
+BenchmarkApplication::BenchmarkApplication(const std::string& inputMeshFile):
+    meshFile(inputMeshFile)
+{
+}
+
+std::shared_ptr<Camera> BenchmarkApplication::CreateCamera() const
+{
+    const glm::vec2 resolution = GetImageOutputResolution();
+    std::shared_ptr<Camera> camera = std::make_shared<PerspectiveCamera>(resolution.x / resolution.y, 26.6f);
+    camera->SetPosition(glm::vec3(0.f, -4.1469f, 0.73693f));
+    camera->Rotate(glm::vec3(1.f, 0.f, 0.f), PI / 2.f);
+    return camera;
+}
+
+std::shared_ptr<Scene> BenchmarkApplication::CreateScene() const
+{
+    std::shared_ptr<Scene> newScene = std::make_shared<Scene>();
+
+    std::shared_ptr<BlinnPhongMaterial> boxMaterial = std::make_shared<BlinnPhongMaterial>();
+    boxMaterial->SetDiffuse(glm::vec3(1.f, 1.f, 1.f));
+    boxMaterial->SetSpecular(glm::vec3(0.6f, 0.6f, 0.6f), 40.f);
+
+    std::vector<std::shared_ptr<aiMaterial>> loadedMaterials;
+    std::vector<std::shared_ptr<MeshObject>> boxObjects = MeshLoader::LoadMesh(meshFile, &loadedMaterials);
+    for (size_t i = 0; i < boxObjects.size(); ++i) {
+        std::shared_ptr<Material> materialCopy = boxMaterial->Clone();
+        materialCopy->LoadMaterialFromAssimp(loadedMaterials[i]);
+        boxObjects[i]->SetMaterial(materialCopy);
+    }
+
+    std::shared_ptr<SceneObject> boxSceneObject = std::make_shared<SceneObject>();
+    boxSceneObject->AddMeshObject(boxObjects);
+    boxSceneObject->Rotate(glm::vec3(1.f, 0.f, 0.f), PI / 2.f);
+    boxSceneObject->CreateAccelerationData(GetAcceleratingStructureType(), GetAcceleratingStructureType());
+    newScene->AddSceneObject(boxSceneObject);
+
+    std::shared_ptr<Light> pointLight = std::make_shared<PointLight>();
+    pointLight->SetPosition(glm::vec3(0.01909f, 0.0101f, 1.77640f));
+    pointLight->SetLightColor(glm::vec3(1.f, 1.f, 1.f));
+    newScene->AddLight(pointLight);
+
+    newScene->GenerateAccelerationData(GetAcceleratingStructureType());
+    return newScene;
+}
+
+std::shared_ptr<ColorSampler> BenchmarkApplication::CreateSampler() const
+{
+    std::shared_ptr<JitterColorSampler> jitter = std::make_shared<JitterColorSampler>();
+    jitter->SetGridSize(GetGridSize());
+    return jitter;
+}
+
+std::shared_ptr<Renderer> BenchmarkApplication::CreateRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) const
+{
+    return std::make_shared<BackwardRenderer>(scene, sampler);
+}
+
+bool BenchmarkApplication::NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex)
+{
+    return true;
+}
\ No newline at end of file
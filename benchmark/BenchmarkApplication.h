@@ -0,0 +1,20 @@
+#pragma once
+
+#include "common/Application.h"
+
+// Renders one of the Cornell box meshes with the assignment 6 camera and light, the same setup for every mesh so
+// that frame times are comparable between them.
+class BenchmarkApplication : public Application
+{
+public:
+    explicit BenchmarkApplication(const std::string& meshFile);
+
+    virtual std::shared_ptr<class Camera> CreateCamera() const override;
+    virtual std::shared_ptr<class Scene> CreateScene() const override;
+    virtual std::shared_ptr<class ColorSampler> CreateSampler() const override;
+    virtual std::shared_ptr<class Renderer> CreateRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler) const override;
+    virtual bool NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex) override;
+
+private:
+    std::string meshFile;
+};
\ No newline at end of file
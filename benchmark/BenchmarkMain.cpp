@@ -0,0 +1,67 @@
+#include "benchmark/Benchmark.h"
+
+namespace
+{
+    void PrintUsage(const char* program)
+    {
+        std::cout << "Usage: " << program << " [options]" << std::endl
+                  << "  --filter <text>     only run benchmarks whose name contains text" << std::endl
+                  << "  --output <file>     JSON results (default benchmark.json)" << std::endl
+                  << "  --min-time <s>      minimum timed seconds per benchmark (default 0.5)" << std::endl
+                  << "  --iterations <n>    minimum timed iterations per benchmark (default 3)" << std::endl
+                  << "  --threads <n>       render threads, 0 for every hardware thread (default 0)" << std::endl
+                  << "  --image-dir <dir>   where rendered frames are written (default .)" << std::endl
+                  << "  --no-render         skip the full-frame renders" << std::endl
+                  << "  --list              print the benchmark names and exit" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSuite suite;
+    std::string outputFile = "benchmark.json";
+    std::string imageDirectory = ".";
+    int numThreads = 0;
+    bool includeRenders = true;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--filter" && hasValue) {
+            suite.SetFilter(argv[++i]);
+        } else if (argument == "--output" && hasValue) {
+            outputFile = argv[++i];
+        } else if (argument == "--min-time" && hasValue) {
+            suite.SetMinimumTime(std::atof(argv[++i]));
+        } else if (argument == "--iterations" && hasValue) {
+            suite.SetMinimumIterations(std::atoi(argv[++i]));
+        } else if (argument == "--threads" && hasValue) {
+            numThreads = std::atoi(argv[++i]);
+        } else if (argument == "--image-dir" && hasValue) {
+            imageDirectory = argv[++i];
+        } else if (argument == "--no-render") {
+            includeRenders = false;
+        } else if (argument == "--list") {
+            listOnly = true;
+        } else {
+            PrintUsage(argv[0]);
+            return (argument == "--help" || argument == "-h") ? 0 : 1;
+        }
+    }
+
+    RegisterKernelBenchmarks(suite);
+    if (includeRenders) {
+        RegisterRenderBenchmarks(suite, numThreads, imageDirectory);
+    }
+
+    if (listOnly) {
+        suite.List(std::cout);
+        return 0;
+    }
+
+    int failedBenchmarks = 0;
+    const std::vector<BenchmarkResult> results = suite.Run(std::cout, failedBenchmarks);
+    const bool wroteResults = BenchmarkSuite::WriteJSON(results, outputFile);
+    return (wroteResults && failedBenchmarks == 0) ? 0 : 1;
+}
\ No newline at end of file
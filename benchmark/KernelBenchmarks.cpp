@@ -0,0 +1,359 @@
+#include "benchmark/Benchmark.h"
+#include "common/core.h"
+#include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
+#include "common/Sampling/PoissonDisks/PoissonDisksColorSampler.h"
+
+namespace
+{
+    const int TRIANGLES_PER_TEST = 64;
+    const int BOXES_PER_TEST = 64;
+    const int RAYS_PER_TEST = 4096;
+
+    const int SOUP_OBJECTS = 4;
+    const int SOUP_TRIANGLES_PER_OBJECT = 5000;
+    const int TRAVERSAL_RESOLUTION = 256;
+
+    const int PHOTON_COUNT = 200000;
+    const int PHOTON_QUERIES = 10000;
+
+    const int SAMPLER_PIXELS = 4096;
+    const int SAMPLER_SAMPLES_PER_PIXEL = 16;
+
+    glm::vec3 RandomVector(RandomGenerator& generator, float scale)
+    {
+        return scale * glm::vec3(2.f * generator.NextFloat() - 1.f, 2.f * generator.NextFloat() - 1.f, 2.f * generator.NextFloat() - 1.f);
+    }
+
+    glm::vec3 RandomDirection(RandomGenerator& generator)
+    {
+        glm::vec3 direction;
+        do {
+            direction = RandomVector(generator, 1.f);
+        } while (glm::dot(direction, direction) > 1.f || glm::dot(direction, direction) < 1e-4f);
+        return glm::normalize(direction);
+    }
+
+    // Rays from a box of side 4 towards the unit region at the origin, so roughly half of them hit.
+    std::vector<Ray> MakeIncoherentRays(int count, uint64_t stream)
+    {
+        RandomGenerator generator(BENCHMARK_SEED, stream);
+        std::vector<Ray> rays;
+        rays.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            const glm::vec3 origin = RandomVector(generator, 4.f);
+            const glm::vec3 target = RandomVector(generator, 1.f);
+            rays.push_back(Ray(origin, glm::normalize(target - origin)));
+        }
+        return rays;
+    }
+
+    // A pinhole camera grid looking at the origin.
+    std::vector<Ray> MakeCoherentRays(int resolution)
+    {
+        const glm::vec3 origin(0.f, 0.f, 6.f);
+        std::vector<Ray> rays;
+        rays.reserve(resolution * resolution);
+        for (int y = 0; y < resolution; ++y) {
+            for (int x = 0; x < resolution; ++x) {
+                const glm::vec3 target(4.f * ((x + 0.5f) / resolution - 0.5f), 4.f * ((y + 0.5f) / resolution - 0.5f), 0.f);
+                rays.push_back(Ray(origin, glm::normalize(target - origin)));
+            }
+        }
+        return rays;
+    }
+
+    void AddRandomTriangles(std::shared_ptr<MeshObject> mesh, int count, float extent, float size, RandomGenerator& generator,
+                            std::vector<std::shared_ptr<Triangle>>* output = nullptr)
+    {
+        for (int t = 0; t < count; ++t) {
+            std::shared_ptr<Triangle> triangle = std::make_shared<Triangle>(mesh.get());
+            const glm::vec3 center = RandomVector(generator, extent);
+            for (int v = 0; v < 3; ++v) {
+                triangle->SetVertexPosition(v, center + RandomVector(generator, size));
+                triangle->SetVertexNormal(v, glm::vec3(0.f, 0.f, 1.f));
+            }
+            mesh->AddPrimitive(triangle);
+            if (output) {
+                output->push_back(triangle);
+            }
+        }
+    }
+
+    std::shared_ptr<Scene> MakeTriangleSoupScene(AccelerationTypes type, MeshStorageModes storageMode)
+    {
+        RandomGenerator generator(BENCHMARK_SEED, 1);
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        for (int o = 0; o < SOUP_OBJECTS; ++o) {
+            std::shared_ptr<MeshObject> mesh = std::make_shared<MeshObject>(std::make_shared<BlinnPhongMaterial>());
+            AddRandomTriangles(mesh, SOUP_TRIANGLES_PER_OBJECT, 1.f, 0.05f, generator);
+
+            std::shared_ptr<SceneObject> object = std::make_shared<SceneObject>();
+            object->AddMeshObject(mesh);
+            object->Translate(glm::vec3(0.25f * o, 0.f, 0.f));
+            object->CreateAccelerationData(type, type);
+            scene->AddSceneObject(object);
+        }
+        scene->GenerateAccelerationData(type);
+        scene->SetMeshStorageMode(storageMode);
+        scene->Finalize();
+        return scene;
+    }
+
+    std::string AccelerationName(AccelerationTypes type)
+    {
+        switch (type) {
+        case AccelerationTypes::BVH:
+            return "bvh";
+        case AccelerationTypes::UNIFORM_GRID:
+            return "grid";
+        case AccelerationTypes::LINEAR_BVH:
+            return "linear_bvh";
+        default:
+            return "naive";
+        }
+    }
+
+    void RegisterPrimitiveBenchmarks(BenchmarkSuite& suite)
+    {
+        suite.Add("primitive/ray_triangle", []() {
+            std::shared_ptr<MeshObject> mesh = std::make_shared<MeshObject>(std::make_shared<BlinnPhongMaterial>());
+            std::shared_ptr<std::vector<std::shared_ptr<Triangle>>> triangles = std::make_shared<std::vector<std::shared_ptr<Triangle>>>();
+            RandomGenerator generator(BENCHMARK_SEED, 2);
+            AddRandomTriangles(mesh, TRIANGLES_PER_TEST, 1.f, 0.5f, generator, triangles.get());
+            std::shared_ptr<SceneObject> parent = std::make_shared<SceneObject>();
+            std::shared_ptr<std::vector<Ray>> rays = std::make_shared<std::vector<Ray>>(MakeIncoherentRays(RAYS_PER_TEST, 3));
+
+            return BenchmarkSuite::BenchmarkIteration([mesh, triangles, parent, rays](double& checksum) {
+                IntersectionState state(0, 0);
+                for (size_t r = 0; r < rays->size(); ++r) {
+                    Ray& ray = (*rays)[r];
+                    const ObjectSpaceRay localRay(ray);
+                    state.intersectionT = std::numeric_limits<float>::max();
+                    for (size_t t = 0; t < triangles->size(); ++t) {
+                        (*triangles)[t]->Trace(parent.get(), localRay, &ray, &state);
+                    }
+                    checksum += (state.intersectionT < std::numeric_limits<float>::max()) ? state.intersectionT : 0.f;
+                }
+                return static_cast<uint64_t>(rays->size() * triangles->size());
+            });
+        });
+
+        suite.Add("primitive/ray_box", []() {
+            RandomGenerator generator(BENCHMARK_SEED, 4);
+            std::shared_ptr<std::vector<Box>> boxes = std::make_shared<std::vector<Box>>();
+            for (int b = 0; b < BOXES_PER_TEST; ++b) {
+                const glm::vec3 center = RandomVector(generator, 1.f);
+                const glm::vec3 halfSize = glm::abs(RandomVector(generator, 0.3f)) + glm::vec3(0.01f);
+                boxes->push_back(Box(center - halfSize, center + halfSize));
+            }
+            std::shared_ptr<std::vector<Ray>> rays = std::make_shared<std::vector<Ray>>(MakeIncoherentRays(RAYS_PER_TEST, 5));
+
+            return BenchmarkSuite::BenchmarkIteration([boxes, rays](double& checksum) {
+                uint64_t hits = 0;
+                for (size_t r = 0; r < rays->size(); ++r) {
+                    Ray& ray = (*rays)[r];
+                    const ObjectSpaceRay localRay(ray);
+                    for (size_t b = 0; b < boxes->size(); ++b) {
+                        hits += (*boxes)[b].Trace(localRay, &ray, nullptr) ? 1 : 0;
+                    }
+                }
+                checksum += static_cast<double>(hits);
+                return static_cast<uint64_t>(rays->size() * boxes->size());
+            });
+        });
+    }
+
+    void RegisterTraversalBenchmarks(BenchmarkSuite& suite)
+    {
+        struct TraversalConfiguration
+        {
+            AccelerationTypes type;
+            MeshStorageModes storageMode;
+        };
+        const TraversalConfiguration configurations[] = {
+            { AccelerationTypes::BVH, MeshStorageModes::PRIMITIVES },
+            { AccelerationTypes::UNIFORM_GRID, MeshStorageModes::PRIMITIVES },
+            { AccelerationTypes::LINEAR_BVH, MeshStorageModes::PRIMITIVES },
+            { AccelerationTypes::LINEAR_BVH, MeshStorageModes::PACKED_TRIANGLES }
+        };
+
+        for (const TraversalConfiguration& configuration : configurations) {
+            std::string prefix = "traversal/" + AccelerationName(configuration.type);
+            if (configuration.storageMode == MeshStorageModes::PACKED_TRIANGLES) {
+                prefix += "_packed";
+            }
+
+            for (int coherent = 1; coherent >= 0; --coherent) {
+                for (int occlusion = 0; occlusion <= 1; ++occlusion) {
+                    const std::string name = prefix + (coherent ? "/coherent" : "/incoherent") + (occlusion ? "/occluded" : "/closest");
+                    suite.Add(name, [configuration, coherent, occlusion]() {
+                        std::shared_ptr<Scene> scene = MakeTriangleSoupScene(configuration.type, configuration.storageMode);
+                        std::shared_ptr<std::vector<Ray>> rays = std::make_shared<std::vector<Ray>>(coherent ?
+                            MakeCoherentRays(TRAVERSAL_RESOLUTION) : MakeIncoherentRays(TRAVERSAL_RESOLUTION * TRAVERSAL_RESOLUTION, 6));
+
+                        // Shadow rays stop short of where they started so some of them end before the geometry.
+                        if (occlusion) {
+                            for (size_t r = 0; r < rays->size(); ++r) {
+                                (*rays)[r].SetMaxT(glm::length((*rays)[r].GetRayPosition(0.f)));
+                            }
+                        }
+
+                        return BenchmarkSuite::BenchmarkIteration([scene, rays, occlusion](double& checksum) {
+                            for (size_t r = 0; r < rays->size(); ++r) {
+                                Ray ray = (*rays)[r];
+                                if (occlusion) {
+                                    checksum += scene->Occluded(&ray) ? 1.0 : 0.0;
+                                } else {
+                                    IntersectionState state(0, 0);
+                                    if (scene->Trace(&ray, &state)) {
+                                        checksum += state.intersectionT;
+                                    }
+                                }
+                            }
+                            return static_cast<uint64_t>(rays->size());
+                        });
+                    });
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<std::vector<glm::vec3>> MakeQueryPositions(int count, uint64_t stream)
+    {
+        RandomGenerator generator(BENCHMARK_SEED, stream);
+        std::shared_ptr<std::vector<glm::vec3>> positions = std::make_shared<std::vector<glm::vec3>>();
+        for (int i = 0; i < count; ++i) {
+            positions->push_back(RandomVector(generator, 1.f));
+        }
+        return positions;
+    }
+
+    std::vector<Photon> MakePhotons()
+    {
+        RandomGenerator generator(BENCHMARK_SEED, 7);
+        std::vector<Photon> photons(PHOTON_COUNT);
+        for (size_t i = 0; i < photons.size(); ++i) {
+            photons[i].position = RandomVector(generator, 1.f);
+            photons[i].SetPower(glm::vec3(generator.NextFloat()));
+            photons[i].SetDirection(RandomDirection(generator));
+            photons[i].SetNormal(RandomDirection(generator));
+        }
+        return photons;
+    }
+
+    void RegisterPhotonMapBenchmarks(BenchmarkSuite& suite)
+    {
+        suite.Add("photon_map/build", []() {
+            std::shared_ptr<std::vector<Photon>> photons = std::make_shared<std::vector<Photon>>(MakePhotons());
+            return BenchmarkSuite::BenchmarkIteration([photons](double& checksum) {
+                // Build consumes its input, so every iteration balances a fresh copy on one thread.
+                std::vector<Photon> input = *photons;
+                PhotonMap map;
+                map.Build(input, 1);
+                checksum += map.GetPhotons().front().position.x;
+                return static_cast<uint64_t>(photons->size());
+            });
+        });
+
+        suite.Add("photon_map/radius_query", []() {
+            std::shared_ptr<PhotonMap> map = std::make_shared<PhotonMap>();
+            std::vector<Photon> photons = MakePhotons();
+            map->Build(photons, 1);
+            std::shared_ptr<std::vector<glm::vec3>> positions = MakeQueryPositions(PHOTON_QUERIES, 8);
+
+            return BenchmarkSuite::BenchmarkIteration([map, positions](double& checksum) {
+                std::vector<const Photon*> found;
+                for (size_t q = 0; q < positions->size(); ++q) {
+                    map->FindWithinRadius((*positions)[q], 0.05f, found);
+                    checksum += static_cast<double>(found.size());
+                }
+                return static_cast<uint64_t>(positions->size());
+            });
+        });
+
+        suite.Add("photon_map/knn_query", []() {
+            std::shared_ptr<PhotonMap> map = std::make_shared<PhotonMap>();
+            std::vector<Photon> photons = MakePhotons();
+            map->Build(photons, 1);
+            std::shared_ptr<std::vector<glm::vec3>> positions = MakeQueryPositions(PHOTON_QUERIES, 9);
+
+            return BenchmarkSuite::BenchmarkIteration([map, positions](double& checksum) {
+                std::vector<PhotonMap::NearestPhoton> found;
+                for (size_t q = 0; q < positions->size(); ++q) {
+                    checksum += map->FindNearest((*positions)[q], 50, 0.2f, found);
+                }
+                return static_cast<uint64_t>(positions->size());
+            });
+        });
+    }
+
+    void RegisterSamplerBenchmark(BenchmarkSuite& suite, const std::string& name, std::function<std::shared_ptr<ColorSampler>()> createSampler)
+    {
+        suite.Add("sampler/" + name, [createSampler]() {
+            std::shared_ptr<ColorSampler> sampler = createSampler();
+            return BenchmarkSuite::BenchmarkIteration([sampler](double& checksum) {
+                // A cheap, smooth color so the adaptive samplers see some variance without the shading dominating.
+                auto colorComputer = [](const glm::vec3& sample) {
+                    return glm::vec3(sample.x * sample.y, sample.y, 0.5f + 0.5f * sample.z);
+                };
+
+                uint64_t samples = 0;
+                PixelSampleStatistics statistics;
+                for (int p = 0; p < SAMPLER_PIXELS; ++p) {
+                    RandomGenerator::GetThreadGenerator().Seed(BENCHMARK_SEED, static_cast<uint64_t>(p));
+                    const glm::vec3 color = sampler->ComputeSamplesAndColor(SAMPLER_SAMPLES_PER_PIXEL, 3, colorComputer, &statistics);
+                    checksum += color.x + color.y + color.z;
+                    samples += statistics.samplesTaken;
+                }
+                return samples;
+            });
+        });
+    }
+
+    void RegisterSamplerBenchmarks(BenchmarkSuite& suite)
+    {
+        RegisterSamplerBenchmark(suite, "random", []() {
+            return std::make_shared<ColorSampler>();
+        });
+        RegisterSamplerBenchmark(suite, "jitter", []() {
+            std::shared_ptr<JitterColorSampler> sampler = std::make_shared<JitterColorSampler>();
+            sampler->SetGridSize(glm::ivec3(4, 4, 1));
+            return sampler;
+        });
+        RegisterSamplerBenchmark(suite, "poisson_disks", []() {
+            std::shared_ptr<PoissonDisksColorSampler> sampler = std::make_shared<PoissonDisksColorSampler>();
+            sampler->SetRadius(0.1f);
+            return sampler;
+        });
+        RegisterSamplerBenchmark(suite, "sobol", []() {
+            return std::make_shared<SobolColorSampler>();
+        });
+        RegisterSamplerBenchmark(suite, "halton", []() {
+            return std::make_shared<HaltonColorSampler>();
+        });
+        RegisterSamplerBenchmark(suite, "blue_noise", []() {
+            return std::make_shared<BlueNoiseColorSampler>();
+        });
+        RegisterSamplerBenchmark(suite, "simple_adaptive", []() {
+            std::shared_ptr<SimpleAdaptiveSampler> sampler = std::make_shared<SimpleAdaptiveSampler>();
+            sampler->SetInternalSampler(std::make_shared<SobolColorSampler>());
+            sampler->SetEarlyExitParameters(0.01f, 4);
+            return sampler;
+        });
+        RegisterSamplerBenchmark(suite, "variance_adaptive", []() {
+            std::shared_ptr<VarianceAdaptiveSampler> sampler = std::make_shared<VarianceAdaptiveSampler>();
+            sampler->SetInternalSampler(std::make_shared<SobolColorSampler>());
+            sampler->SetErrorParameters(0.05f, 4);
+            return sampler;
+        });
+    }
+}
+
+void RegisterKernelBenchmarks(BenchmarkSuite& suite)
+{
+    RegisterPrimitiveBenchmarks(suite);
+    RegisterTraversalBenchmarks(suite);
+    RegisterPhotonMapBenchmarks(suite);
+    RegisterSamplerBenchmarks(suite);
+}
\ No newline at end of file
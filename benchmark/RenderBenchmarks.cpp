@@ -0,0 +1,73 @@
+#include "benchmark/Benchmark.h"
+#include "benchmark/BenchmarkApplication.h"
+#include "common/RayTracer.h"
+#include "common/Acceleration/AccelerationTypes.h"
+
+namespace
+{
+    const char* const CORNELL_BOX_MESHES[] = {
+        "CornellBox-Assignment6",
+        "CornellBox-Assignment8",
+        "CornellBox-Empty-CO",
+        "CornellBox-Empty-RG",
+        "CornellBox-Empty-Squashed",
+        "CornellBox-Empty-White",
+        "CornellBox-Glossy",
+        "CornellBox-Mirror",
+        "CornellBox-Original",
+        "CornellBox-Original-Fix",
+        "CornellBox-Photon",
+        "CornellBox-Sphere",
+        "CornellBox-Water"
+    };
+
+    const glm::ivec2 RENDER_RESOLUTION(160, 120);
+    const int RENDER_GRID_SIZE = 2;
+}
+
+void RegisterRenderBenchmarks(BenchmarkSuite& suite, int numThreads, const std::string& outputDirectory)
+{
+    for (const char* mesh : CORNELL_BOX_MESHES) {
+        const std::string meshName = mesh;
+        suite.Add("render/" + meshName, [meshName, numThreads, outputDirectory]() {
+            std::unique_ptr<BenchmarkApplication> application = make_unique<BenchmarkApplication>("CornellBox/" + meshName + ".obj");
+            application->SetImageOutputResolution(glm::vec2(RENDER_RESOLUTION));
+            application->SetGridSize(glm::ivec3(RENDER_GRID_SIZE, RENDER_GRID_SIZE, 1));
+            application->SetSamplesPerPixel(RENDER_GRID_SIZE * RENDER_GRID_SIZE);
+            application->SetMaxReflectionBounces(2);
+            application->SetMaxRefractionBounces(3);
+            application->SetAcceleratingStructureType(AccelerationTypes::LINEAR_BVH);
+            application->SetNumThreads(numThreads);
+            application->SetRandomSeed(static_cast<uint32_t>(BENCHMARK_SEED));
+            application->SetOutputFilename(outputDirectory + "/" + meshName + ".png");
+
+            // Loading the mesh and building the acceleration structures is setup. Only the tile rendering is timed; the
+            // image is post-processed and written once, after the untimed warm-up, since every frame is the same.
+            std::shared_ptr<RayTracer> rayTracer = std::make_shared<RayTracer>(std::move(application));
+            if (!rayTracer->Init()) {
+                return BenchmarkSuite::BenchmarkIteration();
+            }
+
+            bool imageSaved = false;
+            return BenchmarkSuite::BenchmarkIteration([rayTracer, imageSaved](double& checksum) mutable {
+#if DIAGNOSTICS_ON
+                const uint64_t raysBefore = Diagnostics::Get()->GetStat(DiagnosticsType::RAYS_CREATED);
+#endif
+                // RenderFrame reports per-tile statistics on stdout; keep them out of the benchmark output.
+                std::streambuf* console = std::cout.rdbuf(nullptr);
+                rayTracer->RenderFrame();
+                if (!imageSaved) {
+                    rayTracer->FinishImage();
+                    imageSaved = true;
+                }
+                std::cout.rdbuf(console);
+                std::cout.clear();
+#if DIAGNOSTICS_ON
+                // The ray count is fixed by the seed, so it doubles as a cheap check that the image did not change.
+                checksum += static_cast<double>(Diagnostics::Get()->GetStat(DiagnosticsType::RAYS_CREATED) - raysBefore);
+#endif
+                return static_cast<uint64_t>(RENDER_RESOLUTION.x) * RENDER_RESOLUTION.y * RENDER_GRID_SIZE * RENDER_GRID_SIZE;
+            });
+        });
+    }
+}
\ No newline at end of file
@@ -6,4 +6,5 @@
 #include "common/Acceleration/AccelerationNode.h"
 #include "common/Acceleration/Naive/NaiveAcceleration.h"
 #include "common/Acceleration/BVH/BVHAcceleration.h"
+#include "common/Acceleration/LinearBVH/LinearBVHAcceleration.h"
 #include "common/Acceleration/UniformGrid/UniformGridAcceleration.h"
\ No newline at end of file
@@ -13,6 +13,9 @@ namespace AccelerationGenerator
             case AccelerationTypes::BVH:
                 acceleration = make_unique<BVHAcceleration>();
                 break;
+            case AccelerationTypes::LINEAR_BVH:
+                acceleration = make_unique<LinearBVHAcceleration>();
+                break;
             case AccelerationTypes::UNIFORM_GRID:
                 acceleration = make_unique<UniformGridAcceleration>();
                 break;
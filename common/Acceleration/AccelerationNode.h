@@ -11,7 +11,13 @@ public:
     AccelerationNode();
 
     virtual Box GetBoundingBox() const = 0;
-    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const = 0;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const = 0;
+
+    // Any-hit query: true as soon as something lies between the ray's min and max T.
+    virtual bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const
+    {
+        return Trace(parentObject, localRay, inputRay, nullptr);
+    }
     virtual uint64_t GetUniqueId() const { return uniqueId; }
     virtual std::string GetHumanIdentifier() const { return ""; }
 private:
@@ -21,7 +21,10 @@ public:
         InternalInitialization();
     }
 
-    virtual bool Trace(const class SceneObject* sceneObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const = 0;
+    virtual bool Trace(const class SceneObject* sceneObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const = 0;
+
+    // Returns on the first hit within the ray's extent instead of looking for the closest one.
+    virtual bool Occluded(const class SceneObject* sceneObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const = 0;
 protected:
     std::vector<std::shared_ptr<AccelerationNode>> nodes;
 
@@ -4,5 +4,6 @@ enum class AccelerationTypes
 {
     NONE,
     UNIFORM_GRID,
-    BVH
+    BVH,
+    LINEAR_BVH
 };
\ No newline at end of file
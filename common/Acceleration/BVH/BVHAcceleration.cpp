@@ -8,13 +8,19 @@ BVHAcceleration::BVHAcceleration():
 {
 }
 
-bool BVHAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+bool BVHAcceleration::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
 {
-    return rootNode->Trace(parentObject, inputRay, outputIntersection);
+    return rootNode->Trace(parentObject, localRay, inputRay, outputIntersection);
+}
+
+bool BVHAcceleration::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay) const
+{
+    return rootNode->Occluded(parentObject, localRay, inputRay);
 }
 
 void BVHAcceleration::InternalInitialization()
 {
+    PROFILE_ZONE("BVH Build");
 #if !DISABLE_ACCELERATION_CREATION_TIMER
     DIAGNOSTICS_TIMER(timer, "BVH Creation Time");
 #endif
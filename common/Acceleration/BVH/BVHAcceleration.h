@@ -6,7 +6,8 @@ class BVHAcceleration : public AccelerationStructure
 {
 public:
     BVHAcceleration();
-    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const override;
 
     void SetMaximumChildren(int input);
     void SetNodesOnLeaves(int input);
@@ -48,10 +48,11 @@ void BVHNode::CreateParentNode(std::vector<std::shared_ptr<class AccelerationNod
     }
 }
 
-bool BVHNode::Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const
+bool BVHNode::Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const
 {
+    DIAGNOSTICS_STAT(DiagnosticsType::BVH_NODES_VISITED);
     float previousIntersectionT = outputIntersection ? outputIntersection->intersectionT : 0.f;
-    if (!boundingBox.Trace(parentObject, inputRay, outputIntersection)) {
+    if (!boundingBox.Trace(localRay, inputRay, outputIntersection)) {
         if (outputIntersection) {
             outputIntersection->intersectionT = previousIntersectionT;
         }
@@ -66,16 +67,39 @@ bool BVHNode::Trace(const class SceneObject* parentObject, class Ray* inputRay,
     // Merge these two branches....
     if (isLeafNode) {
         for (size_t i = 0; i < leafNodes.size(); ++i) {
-            hitObject |= leafNodes[i]->Trace(parentObject, inputRay, outputIntersection);
+            hitObject |= leafNodes[i]->Trace(parentObject, localRay, inputRay, outputIntersection);
         }
     } else {
         for (size_t i = 0; i < childBVHNodes.size(); ++i) {
-            hitObject |= childBVHNodes[i]->Trace(parentObject, inputRay, outputIntersection);
+            hitObject |= childBVHNodes[i]->Trace(parentObject, localRay, inputRay, outputIntersection);
         }
     }
     return hitObject;
 }
 
+bool BVHNode::Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::BVH_NODES_VISITED);
+    if (!boundingBox.Trace(localRay, inputRay, nullptr)) {
+        return false;
+    }
+
+    if (isLeafNode) {
+        for (size_t i = 0; i < leafNodes.size(); ++i) {
+            if (leafNodes[i]->Occluded(parentObject, localRay, inputRay)) {
+                return true;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < childBVHNodes.size(); ++i) {
+            if (childBVHNodes[i]->Occluded(parentObject, localRay, inputRay)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 std::string BVHNode::PrintContents() const
 {
     std::ostringstream ss;
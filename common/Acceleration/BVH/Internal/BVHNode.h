@@ -7,7 +7,8 @@ class BVHNode : public std::enable_shared_from_this <BVHNode>
 {
 public:
     BVHNode(std::vector<std::shared_ptr<class AccelerationNode>>& childObjects, int maximumChildren, int nodesOnLeaves, int splitDim = 0);
-    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+    bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+    bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const;
 private:
     void CreateLeafNode(std::vector<std::shared_ptr<class AccelerationNode>>& childObjects);
     void CreateParentNode(std::vector<std::shared_ptr<class AccelerationNode>>& childObjects, int maximumChildren, int nodesOnLeaves, int splitDim);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common/common.h"
+#include <stdint.h>
+
+// A single node of the flattened BVH. Nodes are laid out depth-first so the first child of an interior node always
+// immediately follows it in the array; only the index of the second child needs to be stored. Exactly 32 bytes so
+// two nodes share a cache line.
+struct LinearBVHNode
+{
+    glm::vec3 boundsMin;
+
+    // Leaves: index of the first primitive in the ordered primitive array. Interior nodes: index of the second child.
+    uint32_t offset;
+
+    glm::vec3 boundsMax;
+
+    // Zero for interior nodes.
+    uint16_t primitiveCount;
+
+    // Axis the node was split on; used to pick the near child during traversal.
+    uint8_t splitAxis;
+    uint8_t padding;
+
+    bool IsLeaf() const { return primitiveCount > 0; }
+};
+
+static_assert(sizeof(LinearBVHNode) == 32, "LinearBVHNode is expected to be exactly 32 bytes.");
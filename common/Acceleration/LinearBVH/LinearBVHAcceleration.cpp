@@ -0,0 +1,327 @@
+#include "common/Acceleration/LinearBVH/LinearBVHAcceleration.h"
+#include "common/Scene/SceneObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
+#include "common/Intersection/IntersectionState.h"
+
+namespace
+{
+    // Traversal pushes at most one node per level, so the build depth is capped to the size of the traversal stack.
+    const int TRAVERSAL_STACK_SIZE = 64;
+
+    // LinearBVHNode stores the leaf size in 16 bits.
+    const uint32_t MAX_LEAF_PRIMITIVES = std::numeric_limits<uint16_t>::max();
+    // Levels kept free below the SAH depth limit for halving a range that is too large for one leaf; 2^17 leaves of
+    // MAX_LEAF_PRIMITIVES cover any 32-bit primitive count.
+    const int LEAF_SPLIT_LEVELS = 17;
+
+    // Slab test against the node bounds.
+    inline bool IntersectsNodeBounds(const LinearBVHNode& node, const ObjectSpaceRay& localRay, float maxT)
+    {
+        DIAGNOSTICS_STAT(DiagnosticsType::BOX_INTERSECTIONS);
+        const glm::vec3 t0 = (node.boundsMin - localRay.position) * localRay.inverseDirection;
+        const glm::vec3 t1 = (node.boundsMax - localRay.position) * localRay.inverseDirection;
+        const glm::vec3 slabNear = glm::min(t0, t1);
+        const glm::vec3 slabFar = glm::max(t0, t1);
+
+        const float tNear = std::max(std::max(slabNear.x, slabNear.y), slabNear.z);
+        // Grow the exit distance slightly so rounding never rejects rays grazing flat or thin boxes.
+        const float tFar = std::min(std::min(slabFar.x, slabFar.y), slabFar.z) * (1.f + 4.f * std::numeric_limits<float>::epsilon());
+
+        return tNear <= tFar && tFar >= -SMALL_EPSILON && tNear - maxT <= SMALL_EPSILON;
+    }
+}
+
+LinearBVHAcceleration::LinearBVHAcceleration():
+    maximumNodesOnLeaves(4), numberOfBins(16), traversalCost(0.125f), maximumDepth(TRAVERSAL_STACK_SIZE - 1 - LEAF_SPLIT_LEVELS)
+{
+}
+
+bool LinearBVHAcceleration::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    if (flatNodes.empty()) {
+        return false;
+    }
+
+    uint32_t nodesToVisit[TRAVERSAL_STACK_SIZE];
+    int toVisitOffset = 0;
+    uint32_t currentNodeIndex = 0;
+    bool hitObject = false;
+
+    while (true) {
+        DIAGNOSTICS_STAT(DiagnosticsType::BVH_NODES_VISITED);
+        const LinearBVHNode& node = flatNodes[currentNodeIndex];
+        const float closestT = outputIntersection ? std::min(outputIntersection->intersectionT, inputRay->GetMaxT()) : inputRay->GetMaxT();
+
+        if (IntersectsNodeBounds(node, localRay, closestT)) {
+            if (node.IsLeaf()) {
+                for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+                    if (orderedPrimitives[node.offset + i]->Trace(parentObject, localRay, inputRay, outputIntersection)) {
+                        hitObject = true;
+                        // Shadow rays only care whether something is in the way.
+                        if (!outputIntersection) {
+                            return true;
+                        }
+                    }
+                }
+            } else {
+                // Visit the child on the near side of the split plane first so closer hits prune the far child.
+                if (localRay.directionIsNegative[node.splitAxis]) {
+                    nodesToVisit[toVisitOffset++] = currentNodeIndex + 1;
+                    currentNodeIndex = node.offset;
+                } else {
+                    nodesToVisit[toVisitOffset++] = node.offset;
+                    currentNodeIndex = currentNodeIndex + 1;
+                }
+                continue;
+            }
+        }
+
+        if (toVisitOffset == 0) {
+            break;
+        }
+        currentNodeIndex = nodesToVisit[--toVisitOffset];
+    }
+
+    return hitObject;
+}
+
+bool LinearBVHAcceleration::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay) const
+{
+    if (flatNodes.empty()) {
+        return false;
+    }
+
+    // Any hit will do, so there is no closest T to prune against and the child order does not matter.
+    uint32_t nodesToVisit[TRAVERSAL_STACK_SIZE];
+    int toVisitOffset = 0;
+    uint32_t currentNodeIndex = 0;
+    const float maxT = inputRay->GetMaxT();
+
+    while (true) {
+        DIAGNOSTICS_STAT(DiagnosticsType::BVH_NODES_VISITED);
+        const LinearBVHNode& node = flatNodes[currentNodeIndex];
+        if (IntersectsNodeBounds(node, localRay, maxT)) {
+            if (node.IsLeaf()) {
+                for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+                    if (orderedPrimitives[node.offset + i]->Occluded(parentObject, localRay, inputRay)) {
+                        return true;
+                    }
+                }
+            } else {
+                nodesToVisit[toVisitOffset++] = node.offset;
+                currentNodeIndex = currentNodeIndex + 1;
+                continue;
+            }
+        }
+
+        if (toVisitOffset == 0) {
+            break;
+        }
+        currentNodeIndex = nodesToVisit[--toVisitOffset];
+    }
+
+    return false;
+}
+
+void LinearBVHAcceleration::InternalInitialization()
+{
+    PROFILE_ZONE("Linear BVH Build");
+#if !DISABLE_ACCELERATION_CREATION_TIMER
+    DIAGNOSTICS_TIMER(timer, "Linear BVH Creation Time");
+#endif
+    flatNodes.clear();
+    orderedPrimitives.clear();
+    if (nodes.empty()) {
+        return;
+    }
+
+    if (maximumNodesOnLeaves < 1 || maximumNodesOnLeaves > std::numeric_limits<uint16_t>::max()) {
+        std::cerr << "WARNING: Maximum nodes on leaves is out of range. Clamping it." << std::endl;
+        maximumNodesOnLeaves = glm::clamp(maximumNodesOnLeaves, 1, static_cast<int>(std::numeric_limits<uint16_t>::max()));
+    }
+
+    if (numberOfBins < 2) {
+        std::cerr << "WARNING: Linear BVH needs at least two bins. Setting it to two." << std::endl;
+        numberOfBins = 2;
+    }
+
+    std::vector<BuildPrimitive> buildPrimitives(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        buildPrimitives[i].bounds = nodes[i]->GetBoundingBox();
+        buildPrimitives[i].centroid = buildPrimitives[i].bounds.Center();
+        buildPrimitives[i].index = static_cast<uint32_t>(i);
+    }
+
+    flatNodes.reserve(2 * nodes.size());
+    orderedPrimitives.reserve(nodes.size());
+    BuildRecursive(buildPrimitives, 0, static_cast<uint32_t>(buildPrimitives.size()), 0);
+    flatNodes.shrink_to_fit();
+}
+
+uint32_t LinearBVHAcceleration::BuildRecursive(std::vector<BuildPrimitive>& buildPrimitives, uint32_t begin, uint32_t end, int depth)
+{
+    Box bounds;
+    Box centroidBounds;
+    for (uint32_t i = begin; i < end; ++i) {
+        bounds.IncludeBox(buildPrimitives[i].bounds);
+        centroidBounds.IncludeBox(Box(buildPrimitives[i].centroid, buildPrimitives[i].centroid));
+    }
+
+    const uint32_t nodeIndex = static_cast<uint32_t>(flatNodes.size());
+    flatNodes.emplace_back();
+
+    const uint32_t primitiveCount = end - begin;
+    if (primitiveCount == 1 || (depth >= maximumDepth && primitiveCount <= MAX_LEAF_PRIMITIVES)) {
+        CreateLeafNode(nodeIndex, buildPrimitives, begin, end, bounds);
+        return nodeIndex;
+    }
+
+    if (depth >= maximumDepth) {
+        // Past the SAH depth limit but too many primitives for one leaf: halve the range along the widest centroid axis
+        // until every part fits.
+        const glm::vec3 centroidExtent = centroidBounds.maxVertex - centroidBounds.minVertex;
+        const int splitAxis = (centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z) ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+        const uint32_t middle = begin + primitiveCount / 2;
+        std::nth_element(buildPrimitives.begin() + begin, buildPrimitives.begin() + middle, buildPrimitives.begin() + end, [=](const BuildPrimitive& a, const BuildPrimitive& b) {
+            return a.centroid[splitAxis] < b.centroid[splitAxis];
+        });
+        CreateInteriorNode(nodeIndex, buildPrimitives, begin, middle, end, splitAxis, bounds, depth);
+        return nodeIndex;
+    }
+
+    // Binned SAH: sweep every axis, bucket the primitive centroids and evaluate the cost of splitting between buckets.
+    // Costs are relative to one primitive intersection.
+    struct Bin
+    {
+        Box bounds;
+        uint32_t count = 0;
+    };
+
+    const glm::vec3 centroidExtent = centroidBounds.maxVertex - centroidBounds.minVertex;
+    const float parentArea = std::max(SurfaceArea(bounds), SMALL_EPSILON);
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = -1;
+
+    std::vector<Bin> bins(numberOfBins);
+    std::vector<float> rightCosts(numberOfBins);
+    for (int axis = 0; axis < 3; ++axis) {
+        if (centroidExtent[axis] <= SMALL_EPSILON) {
+            continue;
+        }
+
+        const float binScale = numberOfBins / centroidExtent[axis];
+        std::fill(bins.begin(), bins.end(), Bin());
+        for (uint32_t i = begin; i < end; ++i) {
+            const int bin = std::min(numberOfBins - 1, static_cast<int>((buildPrimitives[i].centroid[axis] - centroidBounds.minVertex[axis]) * binScale));
+            bins[bin].bounds.IncludeBox(buildPrimitives[i].bounds);
+            ++bins[bin].count;
+        }
+
+        // rightCosts[b] is the area-weighted cost of everything in bins (b, numberOfBins).
+        Box rightBounds;
+        uint32_t rightCount = 0;
+        for (int b = numberOfBins - 1; b > 0; --b) {
+            rightBounds.IncludeBox(bins[b].bounds);
+            rightCount += bins[b].count;
+            rightCosts[b - 1] = rightCount ? rightCount * SurfaceArea(rightBounds) : 0.f;
+        }
+
+        Box leftBounds;
+        uint32_t leftCount = 0;
+        for (int b = 0; b < numberOfBins - 1; ++b) {
+            leftBounds.IncludeBox(bins[b].bounds);
+            leftCount += bins[b].count;
+            if (leftCount == 0 || leftCount == primitiveCount) {
+                continue;
+            }
+
+            const float cost = traversalCost + (leftCount * SurfaceArea(leftBounds) + rightCosts[b]) / parentArea;
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    const bool fitsInLeaf = static_cast<int>(primitiveCount) <= maximumNodesOnLeaves;
+    if (fitsInLeaf && (bestAxis < 0 || bestCost >= static_cast<float>(primitiveCount))) {
+        CreateLeafNode(nodeIndex, buildPrimitives, begin, end, bounds);
+        return nodeIndex;
+    }
+
+    uint32_t middle;
+    int splitAxis;
+    if (bestAxis >= 0) {
+        splitAxis = bestAxis;
+        const float binScale = numberOfBins / centroidExtent[splitAxis];
+        const float minCentroid = centroidBounds.minVertex[splitAxis];
+        const int splitBin = bestSplit;
+        const int binCount = numberOfBins;
+        auto firstRight = std::partition(buildPrimitives.begin() + begin, buildPrimitives.begin() + end, [=](const BuildPrimitive& primitive) {
+            return std::min(binCount - 1, static_cast<int>((primitive.centroid[splitAxis] - minCentroid) * binScale)) <= splitBin;
+        });
+        middle = static_cast<uint32_t>(firstRight - buildPrimitives.begin());
+    } else {
+        // All centroids coincide and there are too many primitives for one leaf; any split is as good as another.
+        splitAxis = 0;
+        middle = begin + primitiveCount / 2;
+    }
+    CreateInteriorNode(nodeIndex, buildPrimitives, begin, middle, end, splitAxis, bounds, depth);
+    return nodeIndex;
+}
+
+void LinearBVHAcceleration::CreateInteriorNode(uint32_t nodeIndex, std::vector<BuildPrimitive>& buildPrimitives, uint32_t begin, uint32_t middle, uint32_t end, int splitAxis, const Box& bounds, int depth)
+{
+    assert(middle > begin && middle < end);
+
+    BuildRecursive(buildPrimitives, begin, middle, depth + 1);
+    const uint32_t secondChild = BuildRecursive(buildPrimitives, middle, end, depth + 1);
+
+    LinearBVHNode& node = flatNodes[nodeIndex];
+    node.boundsMin = bounds.minVertex;
+    node.boundsMax = bounds.maxVertex;
+    node.offset = secondChild;
+    node.primitiveCount = 0;
+    node.splitAxis = static_cast<uint8_t>(splitAxis);
+}
+
+void LinearBVHAcceleration::CreateLeafNode(uint32_t nodeIndex, std::vector<BuildPrimitive>& buildPrimitives, uint32_t begin, uint32_t end, const Box& bounds)
+{
+    assert(end - begin <= MAX_LEAF_PRIMITIVES);
+
+    LinearBVHNode& node = flatNodes[nodeIndex];
+    node.boundsMin = bounds.minVertex;
+    node.boundsMax = bounds.maxVertex;
+    node.offset = static_cast<uint32_t>(orderedPrimitives.size());
+    node.primitiveCount = static_cast<uint16_t>(end - begin);
+    node.splitAxis = 0;
+
+    for (uint32_t i = begin; i < end; ++i) {
+        orderedPrimitives.push_back(nodes[buildPrimitives[i].index].get());
+    }
+}
+
+float LinearBVHAcceleration::SurfaceArea(const Box& box)
+{
+    const glm::vec3 diagonal = box.maxVertex - box.minVertex;
+    return 2.f * (diagonal.x * diagonal.y + diagonal.y * diagonal.z + diagonal.z * diagonal.x);
+}
+
+void LinearBVHAcceleration::SetMaximumNodesOnLeaves(int input)
+{
+    maximumNodesOnLeaves = input;
+}
+
+void LinearBVHAcceleration::SetNumberOfBins(int input)
+{
+    numberOfBins = input;
+}
+
+void LinearBVHAcceleration::SetTraversalCost(float input)
+{
+    traversalCost = input;
+}
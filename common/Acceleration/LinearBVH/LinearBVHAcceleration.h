@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common/Acceleration/AccelerationStructure.h"
+#include "common/Acceleration/LinearBVH/Internal/LinearBVHNode.h"
+#include "common/Utility/Memory/AlignedAllocator.h"
+
+class LinearBVHAcceleration : public AccelerationStructure
+{
+public:
+    LinearBVHAcceleration();
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const override;
+
+    void SetMaximumNodesOnLeaves(int input);
+    void SetNumberOfBins(int input);
+    void SetTraversalCost(float input);
+
+    size_t GetNumberOfBVHNodes() const { return flatNodes.size(); }
+
+private:
+    virtual void InternalInitialization() override;
+
+    struct BuildPrimitive
+    {
+        Box bounds;
+        glm::vec3 centroid;
+        uint32_t index;
+    };
+
+    uint32_t BuildRecursive(std::vector<BuildPrimitive>& buildPrimitives, uint32_t begin, uint32_t end, int depth);
+    // Builds both children of [begin, end), split at middle, and turns nodeIndex into their parent.
+    void CreateInteriorNode(uint32_t nodeIndex, std::vector<BuildPrimitive>& buildPrimitives, uint32_t begin, uint32_t middle, uint32_t end, int splitAxis, const Box& bounds, int depth);
+    void CreateLeafNode(uint32_t nodeIndex, std::vector<BuildPrimitive>& buildPrimitives, uint32_t begin, uint32_t end, const Box& bounds);
+
+    static float SurfaceArea(const Box& box);
+
+    int maximumNodesOnLeaves;
+    int numberOfBins;
+    float traversalCost;
+    int maximumDepth;
+
+    std::vector<LinearBVHNode, AlignedAllocator<LinearBVHNode, 32>> flatNodes;
+
+    // Raw pointers into AccelerationStructure::nodes, reordered so that every leaf references a contiguous range.
+    std::vector<const AccelerationNode*> orderedPrimitives;
+};
@@ -7,11 +7,11 @@ void NaiveAcceleration::AddNode(std::shared_ptr<AccelerationNode> node)
     nodes.push_back(std::move(node));
 }
 
-bool NaiveAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+bool NaiveAcceleration::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
 {
     bool hasHit = false;
     for (size_t i = 0; i < nodes.size(); ++i) {
-        bool hit = nodes[i]->Trace(parentObject, inputRay, outputIntersection);
+        bool hit = nodes[i]->Trace(parentObject, localRay, inputRay, outputIntersection);
         // early exit when we just want to know whether or not we hit.
         if (hit && !outputIntersection) {
             return true; 
@@ -19,4 +19,14 @@ bool NaiveAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, In
         hasHit |= hit;
     }  
     return hasHit;
+}
+
+bool NaiveAcceleration::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay) const
+{
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i]->Occluded(parentObject, localRay, inputRay)) {
+            return true;
+        }
+    }
+    return false;
 }
\ No newline at end of file
@@ -9,5 +9,6 @@ public:
     // Only implemented for naive acceleration since it's trivial...
     void AddNode(std::shared_ptr<AccelerationNode> node);
 
-    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const override;
 };
\ No newline at end of file
@@ -16,7 +16,12 @@ void Voxel::AddNode(std::shared_ptr<AccelerationNode> input)
     nodeList->AddNode(std::move(input));
 }
 
-bool Voxel::Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection)
+bool Voxel::Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection)
 {
-    return nodeList->Trace(parentObject, inputRay, outputIntersection);
+    return nodeList->Trace(parentObject, localRay, inputRay, outputIntersection);
+}
+
+bool Voxel::Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay)
+{
+    return nodeList->Occluded(parentObject, localRay, inputRay);
 }
\ No newline at end of file
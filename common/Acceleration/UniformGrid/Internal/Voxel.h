@@ -9,7 +9,8 @@ public:
     Voxel();
     ~Voxel();
     void AddNode(std::shared_ptr<class AccelerationNode> input);
-    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection);
+    bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection);
+    bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay);
 private:
     std::unique_ptr<class NaiveAcceleration> nodeList;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "common/Acceleration/UniformGrid/Internal/VoxelGrid.h"
 #include "common/Acceleration/AccelerationNode.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
 #include "common/Intersection/IntersectionState.h"
 
 #define DEBUG_VOXEL_GRID 0
@@ -57,14 +58,10 @@ bool VoxelGrid::IsInsideGrid(const glm::ivec3& index) const
     return true;
 }
 
-bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection)
+bool VoxelGrid::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection)
 {
-    glm::mat4 spaceTransform(1.f);
-    if (parentObject) {
-        spaceTransform = parentObject->GetWorldToObjectMatrix();
-    }
-    glm::vec3 rayPos = glm::vec3(spaceTransform * inputRay->GetPosition());
-    const glm::vec3 rayDir = glm::vec3(spaceTransform * inputRay->GetForwardDirection());
+    const glm::vec3& rayPos = localRay.position;
+    const glm::vec3& rayDir = localRay.direction;
     glm::ivec3 step;
     for (int i = 0; i < 3; ++i) {
         if (std::abs(rayDir[i]) < SMALL_EPSILON) {
@@ -83,7 +80,7 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
     // If we aren't currently within the grid, move the ray position such that we are.
     if (!IsInsideGrid(currentVoxelIndex)) {
         IntersectionState tempState;
-        if (!boundingBox.Trace(parentObject, inputRay, &tempState)) {
+        if (!boundingBox.Trace(localRay, inputRay, &tempState)) {
             return false;
         }
         const float dt = tempState.intersectionT + SMALL_EPSILON;
@@ -101,7 +98,7 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
 #endif
         IntersectionState tempIntersection;
         tempIntersection.TestAndCopyLimits(outputIntersection);
-        bool hitVoxel = grid[currentVoxelIndex[0]][currentVoxelIndex[1]][currentVoxelIndex[2]].Trace(parentObject, inputRay, &tempIntersection);
+        bool hitVoxel = grid[currentVoxelIndex[0]][currentVoxelIndex[1]][currentVoxelIndex[2]].Trace(parentObject, localRay, inputRay, &tempIntersection);
             
         // Need to verify that the hit position is within the voxel -- otherwise we're looking too far ahead.
         const glm::vec3 hitPosition = rayPos + rayDir * tempIntersection.intersectionT;
@@ -110,7 +107,7 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
 #endif
         if (hitVoxel && GetVoxelForPosition(hitPosition) == currentVoxelIndex)  {
             if (outputIntersection) {
-                *outputIntersection = tempIntersection;
+                outputIntersection->CopyHit(tempIntersection);
             }
 #if DEBUG_VOXEL_GRID
             std::cout << " did done hit" << std::endl;
@@ -131,6 +128,49 @@ bool VoxelGrid::Trace(const SceneObject* parentObject, Ray* inputRay, Intersecti
     return false;
 }
 
+bool VoxelGrid::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay)
+{
+    const glm::vec3& rayPos = localRay.position;
+    const glm::vec3& rayDir = localRay.direction;
+    glm::ivec3 step;
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(rayDir[i]) < SMALL_EPSILON) {
+            step[i] = 0;
+        } else {
+            step[i] = (rayDir[i] > SMALL_EPSILON) ? 1 : -1;
+        }
+    }
+
+    glm::ivec3 currentVoxelIndex = GetVoxelForPosition(rayPos, false);
+    if (!IsInsideGrid(currentVoxelIndex)) {
+        IntersectionState tempState;
+        if (!boundingBox.Trace(localRay, inputRay, &tempState)) {
+            return false;
+        }
+        const float dt = tempState.intersectionT + SMALL_EPSILON;
+        currentVoxelIndex = GetVoxelForPosition(rayPos + rayDir * dt);
+    }
+
+    // Unlike Trace, a hit outside the current voxel still counts as long as it is within the ray's extent, and the
+    // walk can stop at the first voxel that reaches past max T.
+    const float maxT = inputRay->GetMaxT();
+    while (IsInsideGrid(currentVoxelIndex)) {
+        if (grid[currentVoxelIndex[0]][currentVoxelIndex[1]][currentVoxelIndex[2]].Occluded(parentObject, localRay, inputRay)) {
+            return true;
+        }
+
+        int minIndex = 0;
+        float minTMax = 0.f;
+        FindClosestVoxelSide(minIndex, minTMax, currentVoxelIndex, step, rayPos, rayDir);
+        assert(minIndex >= 0);
+        if (minTMax - maxT > SMALL_EPSILON) {
+            break;
+        }
+        currentVoxelIndex[minIndex] += step[minIndex];
+    }
+    return false;
+}
+
 void VoxelGrid::FindClosestVoxelSide(int& dim, float& t, const glm::ivec3& currentVoxelIndex, const glm::ivec3& step, const glm::vec3& rayPos, const glm::vec3& rayDir) const
 {
     const glm::vec3 index(currentVoxelIndex);
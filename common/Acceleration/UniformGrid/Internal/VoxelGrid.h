@@ -11,7 +11,8 @@ public:
     VoxelGrid(Box inputBox, const glm::ivec3& size, const glm::vec3& inputSize);
 
     void AddNodeToGrid(std::shared_ptr<class AccelerationNode> node);
-    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection);
+    bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection);
+    bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay);
 private:
     bool IsInsideGrid(const glm::ivec3& index) const;
     glm::ivec3 GetVoxelForPosition(const glm::vec3& position, bool clamp = true) const;
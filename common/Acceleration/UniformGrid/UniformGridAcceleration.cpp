@@ -7,14 +7,21 @@ UniformGridAcceleration::UniformGridAcceleration():
 {
 }
 
-bool UniformGridAcceleration::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+bool UniformGridAcceleration::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
 {
     assert(voxelGrid);
-    return voxelGrid->Trace(parentObject, inputRay, outputIntersection);
+    return voxelGrid->Trace(parentObject, localRay, inputRay, outputIntersection);
+}
+
+bool UniformGridAcceleration::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay) const
+{
+    assert(voxelGrid);
+    return voxelGrid->Occluded(parentObject, localRay, inputRay);
 }
 
 void UniformGridAcceleration::InternalInitialization()
 {
+    PROFILE_ZONE("Uniform Grid Build");
     Box gridBoundingBox;
 #if !DISABLE_ACCELERATION_CREATION_TIMER
     DIAGNOSTICS_TIMER(timer, "Uniform Grid Creation Time");
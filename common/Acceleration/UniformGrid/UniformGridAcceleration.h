@@ -7,7 +7,8 @@ class UniformGridAcceleration : public AccelerationStructure
 {
 public:
     UniformGridAcceleration();
-    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const override;
 
     void SetSuggestedGridSize(glm::ivec3 input);
 private:
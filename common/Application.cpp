@@ -1,6 +1,7 @@
 #include "common/Application.h"
 #include "common/Acceleration/AccelerationCommon.h"
 #include "common/Output/ImageWriter.h"
+#include "common/Utility/Config/ConfigParsing.h"
 
 
 void Application::SetOutputFilename(const std::string& file)
@@ -13,6 +14,16 @@ std::string Application::GetOutputFilename() const
 	return fileName;
 }
 
+void Application::SetSampleCountFilename(const std::string& file)
+{
+	sampleCountFileName = file;
+}
+
+std::string Application::GetSampleCountFilename() const
+{
+	return sampleCountFileName;
+}
+
 void Application::SetSamplesPerPixel(int numSamples)
 {
 	samplesPerPixel = numSamples;
@@ -43,6 +54,40 @@ glm::ivec3 Application::GetGridSize() const
 	return gridSize;
 }
 
+void Application::SetNumThreads(int threads)
+{
+	numThreads = std::max(threads, 0);
+}
+
+int Application::GetNumThreads() const
+{
+	if (numThreads > 0)
+	{
+		return numThreads;
+	}
+	return std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
+
+void Application::SetTileSize(const glm::ivec2& size)
+{
+	tileSize = glm::max(size, glm::ivec2(1, 1));
+}
+
+glm::ivec2 Application::GetTileSize() const
+{
+	return tileSize;
+}
+
+void Application::SetRandomSeed(uint32_t seed)
+{
+	randomSeed = seed;
+}
+
+uint32_t Application::GetRandomSeed() const
+{
+	return randomSeed;
+}
+
 glm::vec2 Application::GetImageOutputResolution() const
 {
 	return imageResolution;
@@ -50,4 +95,163 @@ glm::vec2 Application::GetImageOutputResolution() const
 
 void Application::PerformImagePostprocessing(class ImageWriter&)
 {
+}
+
+bool Application::ApplySetting(const std::string& name, const std::string& value)
+{
+	int intValue;
+	float floatValue;
+	bool boolValue;
+	uint32_t unsignedValue;
+	glm::vec2 vec2Value;
+	glm::ivec2 ivec2Value;
+	glm::ivec3 ivec3Value;
+	AccelerationTypes accelerationValue;
+	MeshStorageModes storageValue;
+
+	if (name == "resolution")
+	{
+		if (!ConfigParsing::ParseVec2(value, vec2Value) || vec2Value.x < 1.f || vec2Value.y < 1.f)
+		{
+			return false;
+		}
+		SetImageOutputResolution(vec2Value);
+	}
+	else if (name == "spp")
+	{
+		if (!ConfigParsing::ParseInt(value, intValue) || intValue < 1)
+		{
+			return false;
+		}
+		SetSamplesPerPixel(intValue);
+	}
+	else if (name == "min_spp")
+	{
+		if (!ConfigParsing::ParseInt(value, intValue) || intValue < 1)
+		{
+			return false;
+		}
+		SetMinSamplesPerPixel(intValue);
+	}
+	else if (name == "grid")
+	{
+		if (!ConfigParsing::ParseIVec3(value, ivec3Value) || glm::any(glm::lessThan(ivec3Value, glm::ivec3(1))))
+		{
+			return false;
+		}
+		SetGridSize(ivec3Value);
+	}
+	else if (name == "poisson_disks")
+	{
+		if (!ConfigParsing::ParseBool(value, boolValue))
+		{
+			return false;
+		}
+		SetUsePoissonDisksSampler(boolValue);
+	}
+	else if (name == "adaptive")
+	{
+		if (!ConfigParsing::ParseBool(value, boolValue))
+		{
+			return false;
+		}
+		SetUseAdaptiveSampler(boolValue);
+	}
+	else if (name == "adaptive_coef")
+	{
+		if (!ConfigParsing::ParseFloat(value, floatValue))
+		{
+			return false;
+		}
+		SetAdaptiveCoef(floatValue);
+	}
+	else if (name == "adaptive_second_pass")
+	{
+		if (!ConfigParsing::ParseBool(value, boolValue))
+		{
+			return false;
+		}
+		SetUseAdaptiveSecondPass(boolValue);
+	}
+	else if (name == "max_reflection_bounces")
+	{
+		if (!ConfigParsing::ParseInt(value, intValue) || intValue < 0)
+		{
+			return false;
+		}
+		SetMaxReflectionBounces(intValue);
+	}
+	else if (name == "max_refraction_bounces")
+	{
+		if (!ConfigParsing::ParseInt(value, intValue) || intValue < 0)
+		{
+			return false;
+		}
+		SetMaxRefractionBounces(intValue);
+	}
+	else if (name == "min_ray_throughput")
+	{
+		if (!ConfigParsing::ParseFloat(value, floatValue) || floatValue < 0.f)
+		{
+			return false;
+		}
+		SetMinimumRayThroughput(floatValue);
+	}
+	else if (name == "acceleration")
+	{
+		if (!ConfigParsing::ParseAccelerationType(value, accelerationValue))
+		{
+			return false;
+		}
+		SetAcceleratingStructureType(accelerationValue);
+	}
+	else if (name == "mesh_storage")
+	{
+		if (!ConfigParsing::ParseMeshStorageMode(value, storageValue))
+		{
+			return false;
+		}
+		SetMeshStorageMode(storageValue);
+	}
+	else if (name == "threads")
+	{
+		if (!ConfigParsing::ParseInt(value, intValue) || intValue < 0)
+		{
+			return false;
+		}
+		SetNumThreads(intValue);
+	}
+	else if (name == "tile_size")
+	{
+		if (!ConfigParsing::ParseIVec2(value, ivec2Value) || glm::any(glm::lessThan(ivec2Value, glm::ivec2(1))))
+		{
+			return false;
+		}
+		SetTileSize(ivec2Value);
+	}
+	else if (name == "seed")
+	{
+		if (!ConfigParsing::ParseUnsigned(value, unsignedValue))
+		{
+			return false;
+		}
+		SetRandomSeed(unsignedValue);
+	}
+	else if (name == "output")
+	{
+		if (value.empty())
+		{
+			return false;
+		}
+		SetOutputFilename(value);
+	}
+	else if (name == "sample_count_output")
+	{
+		SetSampleCountFilename(value);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
 }
\ No newline at end of file
@@ -1,15 +1,15 @@
 #pragma once
 
 #include "common/common.h"
-
-enum class AccelerationTypes;
+#include "common/Scene/Geometry/Mesh/MeshStorageModes.h"
+#include "common/Acceleration/AccelerationTypes.h"
 
 class Application : public std::enable_shared_from_this<Application>
 {
 public:
-	Application() : samplesPerPixel(1), minSamplesPerPixel(1), maxReflectionBounces(0), maxRefractionBounces(0),
-		gridSize(1, 1, 1), usePoissonDisksSampler(false), useAdaptiveSampler(false), imageResolution(1024, 768),
-		fileName("output.png")
+	Application() : samplesPerPixel(1), minSamplesPerPixel(1), maxReflectionBounces(0), maxRefractionBounces(0), minimumRayThroughput(0.f),
+		gridSize(1, 1, 1), usePoissonDisksSampler(false), useAdaptiveSampler(false), useAdaptiveSecondPass(false), adaptiveCoef(10.f),
+		accelerationStructure(AccelerationTypes::BVH), meshStorageMode(MeshStorageModes::PRIMITIVES), imageResolution(1024, 768), fileName("output.png"), numThreads(0), tileSize(16, 16), randomSeed(0)
 	{
 	}
     virtual ~Application() {}
@@ -19,6 +19,10 @@ public:
     virtual std::shared_ptr<class ColorSampler> CreateSampler() const = 0;
     virtual std::shared_ptr<class Renderer> CreateRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler) const = 0;
 
+	// Sets a property by its scene file / command line name, e.g. ("spp", "16") or ("resolution", "800 600").
+	// Returns false if the name is unknown or the value does not parse. Subclasses add their own names.
+	virtual bool ApplySetting(const std::string& name, const std::string& value);
+
     // Ray tracing properties
 	virtual void SetMaxReflectionBounces(int outputMaxReflectionBounces)
 	{
@@ -38,6 +42,17 @@ public:
 		return maxRefractionBounces;
 	}
 
+	// Reflection/refraction branches that would contribute less than this are culled by Russian roulette, e.g. 0.01.
+	// 0, the default, traces every branch up to the bounce limits.
+	virtual void SetMinimumRayThroughput(float throughput)
+	{
+		minimumRayThroughput = throughput;
+	}
+	virtual float GetMinimumRayThroughput() const
+	{
+		return minimumRayThroughput;
+	}
+
 	// Sampling Properties
 	virtual void SetSamplesPerPixel(int numSamples);
 	virtual int GetSamplesPerPixel() const;
@@ -76,6 +91,18 @@ public:
 		return adaptiveCoef;
 	}
 
+	// Spend the samples the adaptive sampler saved on a second pass over the tiles that are still noisiest. Only
+	// samplers that estimate their error take part. A re-rendered pixel averages both passes by sample count; progressive
+	// photon mapping keeps the visible points of both passes and weights them by the pixel's combined count.
+	virtual void SetUseAdaptiveSecondPass(bool useSecondPass)
+	{
+		useAdaptiveSecondPass = useSecondPass;
+	}
+	virtual bool GetUseAdaptiveSecondPass() const
+	{
+		return useAdaptiveSecondPass;
+	}
+
 	// Whether or not to continue sampling the scene from the camera.
 	virtual bool NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex) = 0;
 
@@ -94,6 +121,27 @@ public:
 		return accelerationStructure;
 	}
 
+	// How mesh triangles are stored for intersection; applied to every mesh in the scene before it is finalized.
+	virtual void SetMeshStorageMode(MeshStorageModes mode)
+	{
+		meshStorageMode = mode;
+	}
+	virtual MeshStorageModes GetMeshStorageMode() const
+	{
+		return meshStorageMode;
+	}
+
+	// Rendering threads -- 0 means use every hardware thread that is available.
+	virtual void SetNumThreads(int threads);
+	virtual int GetNumThreads() const;
+
+	virtual void SetTileSize(const glm::ivec2& size);
+	virtual glm::ivec2 GetTileSize() const;
+
+	// Seed for the per-pixel random streams -- the same seed gives the same image.
+	virtual void SetRandomSeed(uint32_t seed);
+	virtual uint32_t GetRandomSeed() const;
+
 	// Postprocessing
 	virtual void PerformImagePostprocessing(class ImageWriter& imageWriter);
 
@@ -107,21 +155,33 @@ public:
 	virtual void SetOutputFilename(const std::string& file);
 	virtual std::string GetOutputFilename() const;
 
+	// Greyscale image of the samples taken per pixel, scaled to the largest count. Empty disables it.
+	virtual void SetSampleCountFilename(const std::string& file);
+	virtual std::string GetSampleCountFilename() const;
+
 private:
 	int			samplesPerPixel;
 	int			minSamplesPerPixel;
 
 	int			maxReflectionBounces;
 	int			maxRefractionBounces;
+	float		minimumRayThroughput;
 
 	glm::ivec3	gridSize;
 
 	bool		usePoissonDisksSampler;
 	bool		useAdaptiveSampler;
+	bool		useAdaptiveSecondPass;
 	float		adaptiveCoef;
 
 	AccelerationTypes accelerationStructure;
+	MeshStorageModes meshStorageMode;
 
 	glm::vec2	imageResolution;
 	std::string	fileName;
+	std::string	sampleCountFileName;
+
+	int			numThreads;
+	glm::ivec2	tileSize;
+	uint32_t	randomSeed;
 };
\ No newline at end of file
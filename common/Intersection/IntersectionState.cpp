@@ -1,10 +1,114 @@
 #include "common/Intersection/IntersectionState.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+#include "common/Scene/SceneObject.h"
+
+namespace
+{
+    struct IntersectionStatePool
+    {
+        ~IntersectionStatePool()
+        {
+            for (size_t i = 0; i < freeStates.size(); ++i) {
+                delete freeStates[i];
+            }
+        }
+
+        std::vector<IntersectionState*> freeStates;
+    };
+
+    thread_local IntersectionStatePool statePool;
+}
+
+IntersectionState::~IntersectionState()
+{
+    ReleaseSecondaryIntersections();
+}
+
+void IntersectionState::Reset(int reflectionBounces, int refractionBounces)
+{
+    ReleaseSecondaryIntersections();
+    remainingReflectionBounces = reflectionBounces;
+    remainingRefractionBounces = refractionBounces;
+    intersectedPrimitive = nullptr;
+    primitiveParent = nullptr;
+    intersectionRay = Ray();
+    intersectionT = std::numeric_limits<float>::max();
+    hasIntersection = false;
+    currentIOR = 1.f;
+    pathThroughput = 1.f;
+    rouletteWeight = 1.f;
+    primitiveIntersectionWeights.fill(0.f);
+}
+
+void IntersectionState::CopyHit(const IntersectionState& other)
+{
+    ReleaseSecondaryIntersections();
+    remainingReflectionBounces = other.remainingReflectionBounces;
+    remainingRefractionBounces = other.remainingRefractionBounces;
+    intersectedPrimitive = other.intersectedPrimitive;
+    primitiveParent = other.primitiveParent;
+    intersectionRay = other.intersectionRay;
+    intersectionT = other.intersectionT;
+    hasIntersection = other.hasIntersection;
+    currentIOR = other.currentIOR;
+    pathThroughput = other.pathThroughput;
+    rouletteWeight = other.rouletteWeight;
+    primitiveIntersectionWeights = other.primitiveIntersectionWeights;
+}
+
+IntersectionState* IntersectionState::CreateReflectionIntersection(int reflectionBounces, int refractionBounces)
+{
+    if (reflectionIntersection) {
+        ReleasePooledState(reflectionIntersection);
+    }
+    reflectionIntersection = AcquirePooledState(reflectionBounces, refractionBounces);
+    return reflectionIntersection;
+}
+
+IntersectionState* IntersectionState::CreateRefractionIntersection(int reflectionBounces, int refractionBounces)
+{
+    if (refractionIntersection) {
+        ReleasePooledState(refractionIntersection);
+    }
+    refractionIntersection = AcquirePooledState(reflectionBounces, refractionBounces);
+    return refractionIntersection;
+}
+
+void IntersectionState::ReleaseSecondaryIntersections()
+{
+    if (reflectionIntersection) {
+        ReleasePooledState(reflectionIntersection);
+        reflectionIntersection = nullptr;
+    }
+    if (refractionIntersection) {
+        ReleasePooledState(refractionIntersection);
+        refractionIntersection = nullptr;
+    }
+}
+
+IntersectionState* IntersectionState::AcquirePooledState(int reflectionBounces, int refractionBounces)
+{
+    std::vector<IntersectionState*>& freeStates = statePool.freeStates;
+    if (freeStates.empty()) {
+        return new IntersectionState(reflectionBounces, refractionBounces);
+    }
+    IntersectionState* state = freeStates.back();
+    freeStates.pop_back();
+    state->Reset(reflectionBounces, refractionBounces);
+    return state;
+}
+
+void IntersectionState::ReleasePooledState(IntersectionState* state)
+{
+    // Children go back first so that a whole bounce tree is recycled at once.
+    state->ReleaseSecondaryIntersections();
+    statePool.freeStates.push_back(state);
+}
 
 glm::vec3 IntersectionState::ComputeNormal() const
 {
     assert(hasIntersection && intersectedPrimitive && primitiveParent);
-    assert(primitiveIntersectionWeights.size() == static_cast<size_t>(intersectedPrimitive->GetTotalVertices()));
+    assert(intersectedPrimitive->GetTotalVertices() <= MAX_PRIMITIVE_VERTICES);
 
     const glm::mat3 normalTransform = glm::mat3(glm::transpose(glm::inverse(primitiveParent->GetObjectToWorldMatrix())));
 
@@ -33,7 +137,7 @@ glm::vec3 IntersectionState::ComputeNormal() const
 glm::vec2 IntersectionState::ComputeUV() const
 {
     assert(hasIntersection && intersectedPrimitive && primitiveParent);
-    assert(primitiveIntersectionWeights.size() == static_cast<size_t>(intersectedPrimitive->GetTotalVertices()));
+    assert(intersectedPrimitive->GetTotalVertices() <= MAX_PRIMITIVE_VERTICES);
 
     glm::vec2 retUV;
     for (int i = 0; i < intersectedPrimitive->GetTotalVertices(); ++i) {
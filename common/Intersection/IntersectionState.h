@@ -5,16 +5,27 @@
 
 struct IntersectionState
 {
+    // Largest primitive that can report an intersection; enough for triangles.
+    static const int MAX_PRIMITIVE_VERTICES = 3;
+
     IntersectionState() :
-        reflectionIntersection(nullptr), remainingReflectionBounces(0), refractionIntersection(nullptr), remainingRefractionBounces(0), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f)
+        reflectionIntersection(nullptr), refractionIntersection(nullptr)
     {
+        Reset(0, 0);
     }
 
     IntersectionState(int reflectionBounces, int refractionBounces) :
-        reflectionIntersection(nullptr), remainingReflectionBounces(reflectionBounces), refractionIntersection(nullptr), remainingRefractionBounces(refractionBounces), intersectionT(std::numeric_limits<float>::max()), hasIntersection(false), currentIOR(1.f)
+        reflectionIntersection(nullptr), refractionIntersection(nullptr)
     {
+        Reset(reflectionBounces, refractionBounces);
     }
 
+    ~IntersectionState();
+
+    // Secondary intersections are owned through raw pointers, so states are not copyable. Use CopyHit instead.
+    IntersectionState(const IntersectionState&) = delete;
+    IntersectionState& operator=(const IntersectionState&) = delete;
+
     void TestAndCopyLimits(IntersectionState* state)
     {
         if (!state) {
@@ -24,12 +35,22 @@ struct IntersectionState
         remainingRefractionBounces = state->remainingRefractionBounces;
         intersectionT = state->intersectionT;
         currentIOR = state->currentIOR;
+        pathThroughput = state->pathThroughput;
+        rouletteWeight = state->rouletteWeight;
     }
 
-    std::shared_ptr<struct IntersectionState> reflectionIntersection;
+    // Copies everything but the secondary intersections.
+    void CopyHit(const IntersectionState& other);
+
+    // Secondary intersections come from a per-thread pool and go back to it when this state is destroyed, so tracing
+    // reflection and refraction bounces does not allocate once the pool has warmed up.
+    IntersectionState* CreateReflectionIntersection(int reflectionBounces, int refractionBounces);
+    IntersectionState* CreateRefractionIntersection(int reflectionBounces, int refractionBounces);
+
+    IntersectionState* reflectionIntersection;
     int remainingReflectionBounces;
 
-    std::shared_ptr<struct IntersectionState> refractionIntersection;
+    IntersectionState* refractionIntersection;
     int remainingRefractionBounces;
 
     const class PrimitiveBase* intersectedPrimitive;
@@ -39,10 +60,22 @@ struct IntersectionState
     bool hasIntersection;
     float currentIOR;
 
+    // Product of the reflectivities/transmittances that lead to this ray, including any Russian roulette boost.
+    float pathThroughput;
+    // Scale for this ray's shaded color. Above 1 when the ray survived Russian roulette.
+    float rouletteWeight;
+
     // One for each vertex
-    std::vector<float> primitiveIntersectionWeights;
+    std::array<float, MAX_PRIMITIVE_VERTICES> primitiveIntersectionWeights;
 
     // Utility Functions
     glm::vec3 ComputeNormal() const;
     glm::vec2 ComputeUV() const;
-};
\ No newline at end of file
+
+private:
+    void Reset(int reflectionBounces, int refractionBounces);
+    void ReleaseSecondaryIntersections();
+
+    static IntersectionState* AcquirePooledState(int reflectionBounces, int refractionBounces);
+    static void ReleasePooledState(IntersectionState* state);
+};
@@ -7,28 +7,45 @@
 #include "common/Sampling/ColorSampler.h"
 #include "common/Output/ImageWriter.h"
 #include "common/Rendering/Renderer.h"
+#include "common/Scheduling/TileScheduler.h"
+#include "common/Sampling/Random/RandomGenerator.h"
+#include <chrono>
 
 #include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
 
 RayTracer::RayTracer(std::unique_ptr<class Application> app):
-    storedApplication(std::move(app)), imageWriter("output.png", 1024, 768)
+    storedApplication(std::move(app)), imageWriter("output.png", 1024, 768), randomSeed(0), samplingPass(0)
 {
 }
 
-void RayTracer::Init()
+RayTracer::~RayTracer()
 {
+}
+
+bool RayTracer::Init()
+{
+	PROFILE_ZONE("Init");
 	// Scene Setup -- Generate the camera and scene.
 	currentCamera = storedApplication->CreateCamera();
 	currentScene = storedApplication->CreateScene();
 	currentSampler = storedApplication->CreateSampler();
+	if (!currentCamera || !currentScene || !currentSampler)
+	{
+		return false;
+	}
 	currentRenderer = storedApplication->CreateRenderer(currentScene, currentSampler);
-	assert(currentScene && currentCamera && currentSampler && currentRenderer);
+	if (!currentRenderer)
+	{
+		return false;
+	}
 
 	currentSampler->InitializeSampler(storedApplication.get(), currentScene.get());
 
 	// Scene preprocessing -- generate acceleration structures, etc.
 	// After this call, we are guaranteed that the "acceleration" member of the scene and all scene objects within the scene will be non-NULL.
 	currentScene->GenerateDefaultAccelerationData();
+	currentScene->SetMeshStorageMode(storedApplication->GetMeshStorageMode());
+	currentScene->SetMinimumRayThroughput(storedApplication->GetMinimumRayThroughput());
 	currentScene->Finalize();
 
 	currentRenderer->InitializeRenderer();
@@ -40,108 +57,311 @@ void RayTracer::Init()
 	// Perform forward ray tracing
 	maxSamplesPerPixel = storedApplication->GetSamplesPerPixel();
 	assert(maxSamplesPerPixel >= 1);
+	randomSeed = storedApplication->GetRandomSeed();
+
+	pixelStatistics.assign(static_cast<size_t>(currentResolution.x) * static_cast<size_t>(currentResolution.y), PixelSampleStatistics());
+	samplingPass = 0;
+	return true;
 }
 
+void RayTracer::BeginPixel(int c, int r) const
+{
+	// Each pixel (and pass) gets its own stream, so the result does not depend on thread count or tile order.
+	const uint64_t pixelIndex = static_cast<uint64_t>(r) * static_cast<uint64_t>(currentResolution.x) + static_cast<uint64_t>(c);
+	const uint64_t passOffset = static_cast<uint64_t>(samplingPass) * pixelStatistics.size();
+	RandomGenerator::GetThreadGenerator().Seed(randomSeed, passOffset + pixelIndex);
+	currentRenderer->BeginPixel(glm::ivec2(c, r));
+}
 
-void RayTracer::CalculatePixels(int ymin, int ymax)
+
+void RayTracer::CalculatePixels(const glm::ivec2& minPixel, const glm::ivec2& maxPixel)
 {
-	for (int r = ymin; r < ymax; ++r)
+	if (maxSamplesPerPixel == 1)
 	{
-		for (int c = 0; c < static_cast<int>(currentResolution.x); ++c)
+		// A single sample always lands on the pixel center, so the whole tile's camera rays can be generated in one batch.
+		const int tileWidth = maxPixel.x - minPixel.x;
+		const size_t pixelCount = static_cast<size_t>(tileWidth) * static_cast<size_t>(maxPixel.y - minPixel.y);
+		std::vector<glm::vec2> normalizedCoordinates;
+		normalizedCoordinates.reserve(pixelCount);
+		for (int r = minPixel.y; r < maxPixel.y; ++r)
+		{
+			for (int c = minPixel.x; c < maxPixel.x; ++c)
+			{
+				normalizedCoordinates.push_back(glm::vec2(static_cast<float>(c), static_cast<float>(r)) / currentResolution);
+			}
+		}
+
+		std::vector<Ray> cameraRays(pixelCount);
+		currentCamera->GenerateRays(normalizedCoordinates.data(), pixelCount, cameraRays.data());
+
+		for (size_t i = 0; i < pixelCount; ++i)
 		{
-			imageWriter.SetPixelColor(currentSampler->ComputeSamplesAndColor(maxSamplesPerPixel, 2, [&](glm::vec3 inputSample) {
+			const int c = minPixel.x + static_cast<int>(i % tileWidth);
+			const int r = minPixel.y + static_cast<int>(i / tileWidth);
+			BeginPixel(c, r);
+			imageWriter.SetPixelColor(ComputeCameraRayColor(cameraRays[i]), c, r);
+			pixelStatistics[static_cast<size_t>(r) * static_cast<size_t>(currentResolution.x) + c].samplesTaken = 1;
+			currentRenderer->EndPixel(glm::ivec2(c, r), 1);
+		}
+		return;
+	}
+
+	for (int r = minPixel.y; r < maxPixel.y; ++r)
+	{
+		for (int c = minPixel.x; c < maxPixel.x; ++c)
+		{
+			PixelSampleStatistics& statistics = pixelStatistics[static_cast<size_t>(r) * static_cast<size_t>(currentResolution.x) + c];
+			if (samplingPass > 0 && !NeedsMoreSamples(statistics))
+			{
+				continue;
+			}
+
+			BeginPixel(c, r);
+			PixelSampleStatistics passStatistics;
+			glm::vec3 pixelColor = currentSampler->ComputeSamplesAndColor(maxSamplesPerPixel, 2, [&](glm::vec3 inputSample) {
 				const glm::vec3 minRange(-0.5f, -0.5f, 0.f);
 				const glm::vec3 maxRange(0.5f, 0.5f, 0.f);
-				const glm::vec3 sampleOffset = (maxSamplesPerPixel == 1) ? glm::vec3(0.f, 0.f, 0.f) : minRange + (maxRange - minRange) * inputSample;
+				const glm::vec3 sampleOffset = minRange + (maxRange - minRange) * inputSample;
 
 				glm::vec2 normalizedCoordinates(static_cast<float>(c) + sampleOffset.x, static_cast<float>(r) + sampleOffset.y);
 				normalizedCoordinates /= currentResolution;
 
-				// Construct ray, send it out into the scene and see what we hit.
-				std::shared_ptr<Ray> cameraRay = currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates);
-				assert(cameraRay);
+				return ComputeCameraRayColor(currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates));
+			}, &passStatistics);
+
+			if (samplingPass > 0)
+			{
+				// Both passes are unbiased estimates, so weight them by their sample counts.
+				const float previousSamples = static_cast<float>(statistics.samplesTaken);
+				const float newSamples = static_cast<float>(passStatistics.samplesTaken);
+				pixelColor = (imageWriter.GetHDRPixelColor(c, r) * previousSamples + pixelColor * newSamples) / (previousSamples + newSamples);
+				passStatistics.samplesTaken += statistics.samplesTaken;
+			}
+			statistics = passStatistics;
+			imageWriter.SetPixelColor(pixelColor, c, r);
+			// Report the running total, so a renderer weighs what it kept from both passes like the color above.
+			currentRenderer->EndPixel(glm::ivec2(c, r), statistics.samplesTaken);
+		}
+	}
+}
 
-				IntersectionState rayIntersection(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
-				bool didHitScene = currentScene->Trace(cameraRay.get(), &rayIntersection);
 
-				// Use the intersection data to compute the BRDF response.
-				glm::vec3 sampleColor;
-				if (didHitScene)
-				{
-					sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, *cameraRay.get());
-				}
+glm::vec3 RayTracer::ComputeCameraRayColor(Ray cameraRay) const
+{
+	// Send the ray out into the scene and see what we hit.
+	IntersectionState rayIntersection(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
+	bool didHitScene = currentScene->Trace(&cameraRay, &rayIntersection);
 
-				return sampleColor;
-			}), c, r);
-		}
+	// Use the intersection data to compute the BRDF response.
+	glm::vec3 sampleColor;
+	if (didHitScene)
+	{
+		sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, cameraRay);
 	}
+	return sampleColor;
 }
 
 
-void RayTracer::Run()
+void RayTracer::RenderTiles(TileScheduler& scheduler, int threadIndex)
+{
+	RenderTile tile;
+	while (scheduler.AcquireTile(tile))
+	{
+		PROFILE_ZONE("Render Tile");
+		const auto startTime = std::chrono::steady_clock::now();
+		CalculatePixels(tile.minPixel, tile.maxPixel);
+		const auto endTime = std::chrono::steady_clock::now();
+		scheduler.RecordTileTime(tile, threadIndex, std::chrono::duration<double>(endTime - startTime).count());
+	}
+}
+
+
+void RayTracer::RenderScheduledTiles(TileScheduler& scheduler)
 {
-	int numBlocks = static_cast<int>(currentResolution.y) / numThreads;
-	for (int i = 0; i < numThreads; ++i)
+	// The calling thread renders tiles too, so only spawn the additional workers.
+	const int numThreads = storedApplication->GetNumThreads();
+	vThreads.clear();
+	for (int i = 1; i < numThreads; ++i)
 	{
-		vThreads.push_back(std::thread(&RayTracer::CalculatePixels, this, i * numBlocks, std::min((i + 1) * numBlocks, static_cast<int>(currentResolution.y))));
+		vThreads.push_back(std::thread(&RayTracer::RenderTiles, this, std::ref(scheduler), i));
 	}
+	RenderTiles(scheduler, 0);
 
 	for (auto& t : vThreads)
 	{
 		t.join();
 	}
+	vThreads.clear();
+}
 
-	// Apply post-processing steps (i.e. tone-mapper, etc.).
-	storedApplication->PerformImagePostprocessing(imageWriter);
 
-	// Now copy whatever is in the HDR data and store it in the bitmap that we will save (aka everything will get clamped to be [0.0, 1.0]).
-	imageWriter.CopyHDRToBitmap();
+void RayTracer::Run()
+{
+	PROFILE_ZONE("Render");
+	RenderFrame();
+	WriteSampleCountImage();
+	FinishImage();
+}
 
-	// Save image.
-	imageWriter.SaveImage();
+
+void RayTracer::RenderFrame()
+{
+	const glm::ivec2 resolution(static_cast<int>(currentResolution.x), static_cast<int>(currentResolution.y));
+	tileScheduler = make_unique<TileScheduler>(resolution, storedApplication->GetTileSize());
+	RenderScheduledTiles(*tileScheduler);
+	PrintRenderStatistics(std::cout, false);
+
+	if (storedApplication->GetUseAdaptiveSecondPass())
+	{
+		RunAdaptivePass();
+	}
 }
 
 
-void RayTracer::Run2()
+bool RayTracer::NeedsMoreSamples(const PixelSampleStatistics& statistics) const
+{
+	// Only samplers that estimate an error can say a pixel is still noisy; of those pixels, re-render the ones that failed
+	// the sampler's own convergence test.
+	return !statistics.converged && statistics.relativeError > 0.f;
+}
+
+
+void RayTracer::RunAdaptivePass()
+{
+	PROFILE_ZONE("Adaptive Pass");
+	const glm::ivec2 resolution(static_cast<int>(currentResolution.x), static_cast<int>(currentResolution.y));
+
+	int64_t remainingSamples = static_cast<int64_t>(pixelStatistics.size()) * maxSamplesPerPixel;
+	for (const PixelSampleStatistics& statistics : pixelStatistics)
+	{
+		remainingSamples -= statistics.samplesTaken;
+	}
+
+	// Rank the tiles by their summed error. Every unconverged pixel of a chosen tile gets another full budget.
+	struct TileError
+	{
+		int index;
+		int noisyPixels;
+		float error;
+	};
+	std::vector<TileError> tileErrors;
+	for (int i = 0; i < tileScheduler->GetTotalTiles(); ++i)
+	{
+		const RenderTile tile = tileScheduler->GetTile(i);
+		TileError tileError = { i, 0, 0.f };
+		for (int r = tile.minPixel.y; r < tile.maxPixel.y; ++r)
+		{
+			for (int c = tile.minPixel.x; c < tile.maxPixel.x; ++c)
+			{
+				const PixelSampleStatistics& statistics = pixelStatistics[static_cast<size_t>(r) * resolution.x + c];
+				if (NeedsMoreSamples(statistics))
+				{
+					++tileError.noisyPixels;
+					tileError.error += statistics.relativeError;
+				}
+			}
+		}
+		if (tileError.noisyPixels > 0)
+		{
+			tileErrors.push_back(tileError);
+		}
+	}
+	std::sort(tileErrors.begin(), tileErrors.end(), [](const TileError& a, const TileError& b) {
+		return a.error > b.error;
+	});
+
+	std::vector<int> tileOrder;
+	int64_t passSamples = 0;
+	for (const TileError& tileError : tileErrors)
+	{
+		const int64_t tileCost = static_cast<int64_t>(tileError.noisyPixels) * maxSamplesPerPixel;
+		if (tileCost <= remainingSamples)
+		{
+			tileOrder.push_back(tileError.index);
+			remainingSamples -= tileCost;
+			passSamples += tileCost;
+		}
+	}
+
+	std::cout << "Adaptive second pass: " << tileOrder.size() << " of " << tileErrors.size() << " noisy tiles, up to " << passSamples << " samples" << std::endl;
+	if (tileOrder.empty())
+	{
+		return;
+	}
+
+	samplingPass = 1;
+	TileScheduler adaptiveScheduler(resolution, storedApplication->GetTileSize(), std::move(tileOrder));
+	RenderScheduledTiles(adaptiveScheduler);
+	samplingPass = 0;
+}
+
+
+void RayTracer::WriteSampleCountImage() const
 {
-// #pragma omp parallel for num_threads(8)
+	const std::string fileName = storedApplication->GetSampleCountFilename();
+	if (fileName.empty())
+	{
+		return;
+	}
 
-    for (int r = 0; r < static_cast<int>(currentResolution.y); ++r)
+	int maxSamplesTaken = 1;
+	for (const PixelSampleStatistics& statistics : pixelStatistics)
 	{
-        for (int c = 0; c < static_cast<int>(currentResolution.x); ++c) 
+		maxSamplesTaken = std::max(maxSamplesTaken, statistics.samplesTaken);
+	}
+
+	const int width = static_cast<int>(currentResolution.x);
+	const int height = static_cast<int>(currentResolution.y);
+	ImageWriter sampleCountImage(fileName, width, height);
+	for (int r = 0; r < height; ++r)
+	{
+		for (int c = 0; c < width; ++c)
 		{
-            imageWriter.SetPixelColor(currentSampler->ComputeSamplesAndColor(maxSamplesPerPixel, 2, [&](glm::vec3 inputSample) {
-                const glm::vec3 minRange(-0.5f, -0.5f, 0.f);
-                const glm::vec3 maxRange(0.5f, 0.5f, 0.f);
-                const glm::vec3 sampleOffset = (maxSamplesPerPixel == 1) ? glm::vec3(0.f, 0.f, 0.f) : minRange + (maxRange - minRange) * inputSample;
+			const float samples = static_cast<float>(pixelStatistics[static_cast<size_t>(r) * width + c].samplesTaken);
+			sampleCountImage.SetPixelColor(glm::vec3(samples / static_cast<float>(maxSamplesTaken)), c, r);
+		}
+	}
+	sampleCountImage.CopyHDRToBitmap();
+	sampleCountImage.SaveImage();
+	std::cout << "Sample counts written to " << fileName << " (white = " << maxSamplesTaken << " samples)" << std::endl;
+}
 
-                glm::vec2 normalizedCoordinates(static_cast<float>(c) + sampleOffset.x, static_cast<float>(r) + sampleOffset.y);
-                normalizedCoordinates /= currentResolution;
 
-                // Construct ray, send it out into the scene and see what we hit.
-                std::shared_ptr<Ray> cameraRay = currentCamera->GenerateRayForNormalizedCoordinates(normalizedCoordinates);
-                assert(cameraRay);
+void RayTracer::Run2()
+{
+	CalculatePixels(glm::ivec2(0, 0), glm::ivec2(static_cast<int>(currentResolution.x), static_cast<int>(currentResolution.y)));
+	FinishImage();
+}
+
 
-                IntersectionState rayIntersection(storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces());
-                bool didHitScene = currentScene->Trace(cameraRay.get(), &rayIntersection);
+void RayTracer::FinishImage()
+{
+	// Let progressive renderers refine the image now that every pixel has been shaded once.
+	{
+		PROFILE_ZONE("Refine Image");
+		currentRenderer->RefineImage(imageWriter);
+	}
 
-                // Use the intersection data to compute the BRDF response.
-                glm::vec3 sampleColor;
-                if (didHitScene) 
-				{
-                    sampleColor = currentRenderer->ComputeSampleColor(rayIntersection, *cameraRay.get());
-                }
-                return sampleColor;
-            }), c, r);
-        }
-    }
-
-    // Apply post-processing steps (i.e. tone-mapper, etc.).
-    storedApplication->PerformImagePostprocessing(imageWriter);
-
-    // Now copy whatever is in the HDR data and store it in the bitmap that we will save (aka everything will get clamped to be [0.0, 1.0]).
-    imageWriter.CopyHDRToBitmap();
-
-    // Save image.
-    imageWriter.SaveImage();
-}
\ No newline at end of file
+	// Apply post-processing steps (i.e. tone-mapper, etc.).
+	{
+		PROFILE_ZONE("Postprocess");
+		storedApplication->PerformImagePostprocessing(imageWriter);
+	}
+
+	// Now copy whatever is in the HDR data and store it in the bitmap that we will save (aka everything will get clamped to be [0.0, 1.0]).
+	PROFILE_ZONE("Save Image");
+	imageWriter.CopyHDRToBitmap();
+
+	// Save image.
+	imageWriter.SaveImage();
+}
+
+
+void RayTracer::PrintRenderStatistics(std::ostream& output, bool includePerTileTimes) const
+{
+	if (tileScheduler)
+	{
+		output << "Threads number " << storedApplication->GetNumThreads() << std::endl;
+		tileScheduler->PrintStatistics(output, includePerTileTimes);
+	}
+}
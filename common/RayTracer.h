@@ -2,8 +2,7 @@
 
 #include "common/common.h"
 #include "common/Output/ImageWriter.h"
-
-const static int numThreads = 8;
+#include "common/Sampling/ColorSampler.h"
 
 class ImageWriter;
 
@@ -11,14 +10,33 @@ class RayTracer
 {
 public:
     RayTracer(std::unique_ptr<class Application> app);
+	~RayTracer();
 
-	void Init();
+	// Returns false if the application could not create its camera, scene, sampler or renderer; nothing can be rendered then.
+	bool Init();
 
-	void CalculatePixels(int ymin, int ymax);
+	void CalculatePixels(const glm::ivec2& minPixel, const glm::ivec2& maxPixel);
     void Run();
 	void Run2();
 
+	// Renders every pixel, including the adaptive second pass, without refining, post-processing or saving the image.
+	// Run is RenderFrame followed by FinishImage.
+	void RenderFrame();
+	// Lets the renderer refine the image, then post-processes and saves it.
+	void FinishImage();
+
+	void PrintRenderStatistics(std::ostream& output, bool includePerTileTimes) const;
+
 private:
+	void RenderScheduledTiles(class TileScheduler& scheduler);
+	void RenderTiles(class TileScheduler& scheduler, int threadIndex);
+	void BeginPixel(int c, int r) const;
+	// Second adaptive pass -- re-renders the noisiest tiles with the samples the first pass did not use.
+	void RunAdaptivePass();
+	bool NeedsMoreSamples(const PixelSampleStatistics& statistics) const;
+	void WriteSampleCountImage() const;
+	glm::vec3 ComputeCameraRayColor(class Ray cameraRay) const;
+
     std::unique_ptr<class Application>	storedApplication;
 
 	std::shared_ptr<class Camera>		currentCamera;
@@ -29,6 +47,11 @@ private:
 	glm::vec2		currentResolution;
 	ImageWriter		imageWriter;
 	int				maxSamplesPerPixel;
+	uint32_t		randomSeed;
+
+	std::vector<PixelSampleStatistics> pixelStatistics;
+	int				samplingPass;
 
+	std::unique_ptr<class TileScheduler> tileScheduler;
 	std::vector<std::thread> vThreads;
-};
\ No newline at end of file
+};
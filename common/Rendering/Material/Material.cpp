@@ -66,7 +66,7 @@ glm::vec3 Material::ComputeReflection(const class Renderer* renderer, const stru
     glm::vec3 reflectedColor;
     if (intersection.reflectionIntersection && intersection.reflectionIntersection->hasIntersection) 
 	{
-        reflectedColor = renderer->ComputeSampleColor(*intersection.reflectionIntersection.get(), intersection.reflectionIntersection->intersectionRay);
+        reflectedColor = intersection.reflectionIntersection->rouletteWeight * renderer->ComputeSampleColor(*intersection.reflectionIntersection, intersection.reflectionIntersection->intersectionRay);
     }
     return reflectedColor;
 }
@@ -76,7 +76,7 @@ glm::vec3 Material::ComputeTransmission(const class Renderer* renderer, const st
     glm::vec3 transmissionColor;
     if (intersection.refractionIntersection && intersection.refractionIntersection->hasIntersection) 
 	{
-        transmissionColor = renderer->ComputeSampleColor(*intersection.refractionIntersection.get(), intersection.refractionIntersection->intersectionRay);
+        transmissionColor = intersection.refractionIntersection->rouletteWeight * renderer->ComputeSampleColor(*intersection.refractionIntersection, intersection.refractionIntersection->intersectionRay);
     }
     return transmissionColor;
 }
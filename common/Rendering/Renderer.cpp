@@ -9,4 +9,16 @@ Renderer::Renderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> s
 
 Renderer::~Renderer()
 {
+}
+
+void Renderer::BeginPixel(const glm::ivec2& pixel) const
+{
+}
+
+void Renderer::EndPixel(const glm::ivec2& pixel, int samplesTaken) const
+{
+}
+
+void Renderer::RefineImage(ImageWriter& image)
+{
 }
\ No newline at end of file
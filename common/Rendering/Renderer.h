@@ -11,6 +11,17 @@ public:
     virtual void InitializeRenderer() = 0;
     
     virtual glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const = 0;
+
+    // Called by the ray tracer before the camera samples of a pixel are shaded on the calling thread. Renderers that keep
+    // per-pixel state use it to tie the following ComputeSampleColor calls to the image.
+    virtual void BeginPixel(const glm::ivec2& pixel) const;
+
+    // Called on the same thread once those samples are done, with the number of samples the pixel has taken so far.
+    // The pixel is the average of that many samples, whatever the configured maximum was.
+    virtual void EndPixel(const glm::ivec2& pixel, int samplesTaken) const;
+
+    // Called once every pixel has been shaded. Progressive renderers add their refined contribution to the image here.
+    virtual void RefineImage(class ImageWriter& image);
 protected:
     std::shared_ptr<class Scene> storedScene;
     std::shared_ptr<class ColorSampler> storedSampler;
@@ -44,7 +44,7 @@ glm::vec3 BackwardRenderer::ComputeSampleColor(const IntersectionState& intersec
         for (size_t s = 0; s < sampleRays.size(); ++s) 
 		{
             // note that max T should be set to be right before the light.
-            if (storedScene->Trace(&sampleRays[s], nullptr)) 
+            if (storedScene->Occluded(&sampleRays[s])) 
 			{
                 continue;
             }
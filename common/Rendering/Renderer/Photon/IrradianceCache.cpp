@@ -0,0 +1,172 @@
+#include "common/Rendering/Renderer/Photon/IrradianceCache.h"
+
+namespace
+{
+const int MAX_OCTREE_DEPTH = 20;
+// A depth-first walk holds at most the unvisited siblings on every level of the current path.
+const int MAX_VISIT_STACK = 8 * (MAX_OCTREE_DEPTH + 1);
+
+int ChildIndex(const glm::vec3& center, const glm::vec3& position)
+{
+    return (position.x > center.x ? 1 : 0) | (position.y > center.y ? 2 : 0) | (position.z > center.z ? 4 : 0);
+}
+
+bool IsInside(const glm::vec3& center, float halfSize, const glm::vec3& position)
+{
+    const glm::vec3 offset = glm::abs(position - center);
+    return offset.x <= halfSize && offset.y <= halfSize && offset.z <= halfSize;
+}
+
+float Luminance(const glm::vec3& color)
+{
+    return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+// Largest R for which irradiance changing by irradianceDifference over distance still stays within the accuracy at the
+// edge of the record, accuracy * R away: R <= E / |grad E|.
+float GradientLimitedRadius(float irradiance, float irradianceDifference, float distance)
+{
+    if (irradianceDifference <= SMALL_EPSILON * irradiance) {
+        return std::numeric_limits<float>::max();
+    }
+    return irradiance * distance / irradianceDifference;
+}
+}
+
+IrradianceCache::IrradianceCache():
+    accuracy(0.2f), minRadius(0.f), maxRadius(std::numeric_limits<float>::max())
+{
+    Reset(glm::vec3(-1.f), glm::vec3(1.f), accuracy, minRadius, maxRadius);
+}
+
+void IrradianceCache::Reset(const glm::vec3& minBounds, const glm::vec3& maxBounds, float inputAccuracy, float minSpacing, float maxSpacing)
+{
+    std::lock_guard<ReaderWriterLock> lock(cacheLock);
+
+    accuracy = inputAccuracy;
+    minRadius = minSpacing;
+    maxRadius = maxSpacing;
+
+    records.clear();
+    root = make_unique<Node>();
+    root->center = (minBounds + maxBounds) * 0.5f;
+    const glm::vec3 extent = (maxBounds - minBounds) * 0.5f;
+    root->halfSize = std::max(std::max(extent.x, extent.y), std::max(extent.z, SMALL_EPSILON));
+}
+
+float IrradianceCache::ComputeWeight(const Record& record, const glm::vec3& position, const glm::vec3& normal) const
+{
+    const glm::vec3 offset = position - record.position;
+
+    // Skip records that sit in front of the shading point; they see occluders the point does not.
+    if (glm::dot(offset, (normal + record.normal) * 0.5f) < -0.05f * record.harmonicMeanDistance) {
+        return 0.f;
+    }
+
+    const float normalDeviation = std::sqrt(std::max(1.f - glm::dot(normal, record.normal), 0.f));
+    const float error = glm::length(offset) / record.harmonicMeanDistance + normalDeviation;
+    if (error >= accuracy) {
+        return 0.f;
+    }
+    return 1.f / std::max(error, SMALL_EPSILON);
+}
+
+template<typename Visitor>
+void IrradianceCache::VisitCandidates(const glm::vec3& position, Visitor visitor) const
+{
+    // A record lives in a node whose half size is at least its validity radius, so it can only reach points within one
+    // half size of that node's bounds.
+    const Node* stack[MAX_VISIT_STACK];
+    int stackSize = 0;
+    stack[stackSize++] = root.get();
+    while (stackSize > 0) {
+        const Node* node = stack[--stackSize];
+
+        for (int index : node->records) {
+            visitor(index);
+        }
+
+        for (int i = 0; i < 8; ++i) {
+            const Node* child = node->children[i].get();
+            if (child && IsInside(child->center, 2.f * child->halfSize, position)) {
+                assert(stackSize < MAX_VISIT_STACK);
+                stack[stackSize++] = child;
+            }
+        }
+    }
+}
+
+bool IrradianceCache::Lookup(const glm::vec3& position, const glm::vec3& normal, glm::vec3& outputIrradiance) const
+{
+    SharedLockGuard lock(cacheLock);
+
+    glm::vec3 weightedIrradiance;
+    float totalWeight = 0.f;
+    VisitCandidates(position, [&](int index) {
+        const Record& record = records[index];
+        const float weight = ComputeWeight(record, position, normal);
+        weightedIrradiance += weight * record.irradiance;
+        totalWeight += weight;
+    });
+
+    if (totalWeight <= 0.f) {
+        return false;
+    }
+    outputIrradiance = weightedIrradiance / totalWeight;
+    return true;
+}
+
+void IrradianceCache::Insert(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& irradiance, float harmonicMeanDistance)
+{
+    std::lock_guard<ReaderWriterLock> lock(cacheLock);
+
+    Record newRecord;
+    newRecord.position = position;
+    newRecord.normal = normal;
+    newRecord.irradiance = irradiance;
+    newRecord.harmonicMeanDistance = glm::clamp(harmonicMeanDistance, minRadius / accuracy, maxRadius / accuracy);
+
+    // Limit how fast R can change between neighbours, in both directions, and limit both records by the irradiance
+    // gradient between them. Records facing another way see different lighting and say nothing about the gradient.
+    const float newLuminance = Luminance(irradiance);
+    VisitCandidates(position, [&](int index) {
+        Record& record = records[index];
+        const float distance = glm::distance(record.position, position);
+        newRecord.harmonicMeanDistance = std::min(newRecord.harmonicMeanDistance, record.harmonicMeanDistance + distance);
+        record.harmonicMeanDistance = std::min(record.harmonicMeanDistance, newRecord.harmonicMeanDistance + distance);
+
+        if (distance > SMALL_EPSILON && glm::dot(record.normal, normal) > 0.9f) {
+            const float recordLuminance = Luminance(record.irradiance);
+            const float difference = std::abs(recordLuminance - newLuminance);
+            newRecord.harmonicMeanDistance = std::min(newRecord.harmonicMeanDistance, GradientLimitedRadius(newLuminance, difference, distance));
+            record.harmonicMeanDistance = std::max(std::min(record.harmonicMeanDistance, GradientLimitedRadius(recordLuminance, difference, distance)), minRadius / accuracy);
+        }
+    });
+    newRecord.harmonicMeanDistance = std::max(newRecord.harmonicMeanDistance, minRadius / accuracy);
+
+    const int recordIndex = static_cast<int>(records.size());
+    records.push_back(newRecord);
+
+    // Descend while the child is still at least as large as the validity radius. Records outside the root stay there.
+    const float validRadius = accuracy * newRecord.harmonicMeanDistance;
+    Node* node = root.get();
+    if (IsInside(node->center, node->halfSize, position)) {
+        for (int depth = 0; depth < MAX_OCTREE_DEPTH && node->halfSize * 0.5f >= validRadius; ++depth) {
+            const int childIndex = ChildIndex(node->center, position);
+            std::unique_ptr<Node>& child = node->children[childIndex];
+            if (!child) {
+                child = make_unique<Node>();
+                child->halfSize = node->halfSize * 0.5f;
+                child->center = node->center + child->halfSize * glm::vec3((childIndex & 1) ? 1.f : -1.f, (childIndex & 2) ? 1.f : -1.f, (childIndex & 4) ? 1.f : -1.f);
+            }
+            node = child.get();
+        }
+    }
+    node->records.push_back(recordIndex);
+}
+
+size_t IrradianceCache::GetTotalRecords() const
+{
+    SharedLockGuard lock(cacheLock);
+    return records.size();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Utility/Threading/ReaderWriterLock.h"
+
+// Ward-style irradiance cache for the final gather. Records are filled lazily by whichever render thread first needs
+// one and are shared by all threads through an octree. Each record is valid out to accuracy * R, where R is the
+// harmonic mean distance of its gather rays. R is clamped so it grows by at most the distance between neighbouring
+// records, which keeps the cache dense where nearby geometry makes lighting change quickly, and it is also bounded by
+// E / |grad E| so that a record stops where a linear change in irradiance would exceed the accuracy. The gradient is
+// estimated from the differences to the neighbouring records, since the gather rays are not stratified.
+// Lookups only take the shared side of the lock, so threads block each other only while a record is being inserted.
+class IrradianceCache
+{
+public:
+    IrradianceCache();
+
+    // Clears the cache. minSpacing and maxSpacing bound the radius a single record can cover.
+    void Reset(const glm::vec3& minBounds, const glm::vec3& maxBounds, float inputAccuracy, float minSpacing, float maxSpacing);
+
+    // Interpolates every record that is valid at position/normal. Returns false if there are none.
+    bool Lookup(const glm::vec3& position, const glm::vec3& normal, glm::vec3& outputIrradiance) const;
+    void Insert(const glm::vec3& position, const glm::vec3& normal, const glm::vec3& irradiance, float harmonicMeanDistance);
+
+    size_t GetTotalRecords() const;
+
+private:
+    struct Record
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 irradiance;
+        float harmonicMeanDistance;
+    };
+
+    struct Node
+    {
+        glm::vec3 center;
+        float halfSize;
+        std::vector<int> records;
+        std::unique_ptr<Node> children[8];
+    };
+
+    // Ward's weight of record at position/normal, or 0 if the record should not be used there.
+    float ComputeWeight(const Record& record, const glm::vec3& position, const glm::vec3& normal) const;
+
+    // Calls visitor for every record whose validity region could contain position.
+    template<typename Visitor>
+    void VisitCandidates(const glm::vec3& position, Visitor visitor) const;
+
+    float accuracy;
+    float minRadius;
+    float maxRadius;
+
+    std::vector<Record> records;
+    std::unique_ptr<Node> root;
+    mutable ReaderWriterLock cacheLock;
+};
@@ -1 +1,89 @@
-#include "common/Rendering/Renderer/Photon/Photon.h"
\ No newline at end of file
+#include "common/Rendering/Renderer/Photon/Photon.h"
+
+static_assert(sizeof(Photon) <= 24, "Photon should stay small enough for large maps to fit in cache.");
+
+namespace
+{
+// Maps a unit vector onto the octahedron |x| + |y| + |z| = 1, unfolds it onto [-1, 1]^2 and quantizes each coordinate
+// to a byte.
+void EncodeOctahedral(const glm::vec3& input, uint8_t output[2])
+{
+    glm::vec3 v = input / (std::abs(input.x) + std::abs(input.y) + std::abs(input.z));
+    glm::vec2 folded(v.x, v.y);
+    if (v.z < 0.f) {
+        folded.x = (1.f - std::abs(v.y)) * (v.x >= 0.f ? 1.f : -1.f);
+        folded.y = (1.f - std::abs(v.x)) * (v.y >= 0.f ? 1.f : -1.f);
+    }
+    output[0] = static_cast<uint8_t>(std::round(glm::clamp(folded.x * 0.5f + 0.5f, 0.f, 1.f) * 255.f));
+    output[1] = static_cast<uint8_t>(std::round(glm::clamp(folded.y * 0.5f + 0.5f, 0.f, 1.f) * 255.f));
+}
+
+glm::vec3 DecodeOctahedral(const uint8_t input[2])
+{
+    const float x = static_cast<float>(input[0]) * (2.f / 255.f) - 1.f;
+    const float y = static_cast<float>(input[1]) * (2.f / 255.f) - 1.f;
+    glm::vec3 v(x, y, 1.f - std::abs(x) - std::abs(y));
+    if (v.z < 0.f) {
+        const float unfoldedX = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+        const float unfoldedY = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+        v.x = unfoldedX;
+        v.y = unfoldedY;
+    }
+    return glm::normalize(v);
+}
+}
+
+Photon::Photon():
+    position(0.f), splitAxis(0)
+{
+    power[0] = power[1] = power[2] = power[3] = 0;
+    direction[0] = direction[1] = 128;
+    normal[0] = normal[1] = 128;
+}
+
+void Photon::SetPower(const glm::vec3& input)
+{
+    // Ward's RGBE: the three mantissas share the exponent of the largest channel.
+    const float largest = std::max(input.x, std::max(input.y, input.z));
+    if (largest < 1e-32f) {
+        power[0] = power[1] = power[2] = power[3] = 0;
+        return;
+    }
+
+    int exponent;
+    const float scale = std::frexp(largest, &exponent) * 256.f / largest;
+    power[0] = static_cast<uint8_t>(std::max(input.x, 0.f) * scale);
+    power[1] = static_cast<uint8_t>(std::max(input.y, 0.f) * scale);
+    power[2] = static_cast<uint8_t>(std::max(input.z, 0.f) * scale);
+    power[3] = static_cast<uint8_t>(exponent + 128);
+}
+
+glm::vec3 Photon::GetPower() const
+{
+    if (power[3] == 0) {
+        return glm::vec3();
+    }
+
+    const float scale = std::ldexp(1.f, static_cast<int>(power[3]) - (128 + 8));
+    return glm::vec3(power[0], power[1], power[2]) * scale;
+}
+
+void Photon::SetDirection(const glm::vec3& input)
+{
+    EncodeOctahedral(input, direction);
+}
+
+glm::vec3 Photon::GetDirection() const
+{
+    return DecodeOctahedral(direction);
+}
+
+void Photon::SetNormal(const glm::vec3& input)
+{
+    EncodeOctahedral(input, normal);
+}
+
+glm::vec3 Photon::GetNormal() const
+{
+    return DecodeOctahedral(normal);
+}
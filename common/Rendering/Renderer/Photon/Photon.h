@@ -1,21 +1,27 @@
 #pragma once
 
 #include "common/common.h"
-#include "common/Scene/Geometry/Ray/Ray.h"
 
+// Packed 24 byte photon record. Power is stored as shared-exponent RGBE, and the incoming direction and surface normal
+// are octahedral-encoded into two bytes each, so maps with millions of photons stay small enough to live in cache.
 struct Photon
 {
-    typedef float value_type;
     glm::vec3 position;
-	glm::vec3 normal;
-    glm::vec3 intensity;
-    Ray toLightRay;
-    
-    inline value_type operator[](size_t const N) const { return position[static_cast<int>(N)]; }
-};
+    uint8_t power[4];
+    uint8_t direction[2];
+    uint8_t normal[2];
+    // Kd-tree split axis, written by PhotonMap when the map is balanced.
+    uint8_t splitAxis;
 
-struct PhotonAccessor
-{
-    typedef float result_type;
-    float operator()(const Photon& t, size_t k) const { return t[k]; }
-};
\ No newline at end of file
+    Photon();
+
+    void SetPower(const glm::vec3& input);
+    glm::vec3 GetPower() const;
+
+    // Unit direction from the photon's hit point back towards where it came from.
+    void SetDirection(const glm::vec3& input);
+    glm::vec3 GetDirection() const;
+
+    void SetNormal(const glm::vec3& input);
+    glm::vec3 GetNormal() const;
+};
@@ -0,0 +1,168 @@
+#include "common/Rendering/Renderer/Photon/PhotonMap.h"
+
+namespace
+{
+// Number of nodes in the left subtree of a left-balanced (complete) binary tree holding totalNodes nodes.
+size_t LeftSubtreeSize(size_t totalNodes)
+{
+    if (totalNodes <= 1) {
+        return 0;
+    }
+
+    size_t lastLevelCapacity = 1;
+    while (lastLevelCapacity * 2 <= totalNodes) {
+        lastLevelCapacity *= 2;
+    }
+
+    const size_t lastLevelNodes = totalNodes - (lastLevelCapacity - 1);
+    const size_t halfCapacity = lastLevelCapacity / 2;
+    return (halfCapacity - 1) + std::min(lastLevelNodes, halfCapacity);
+}
+
+bool CompareNearest(const PhotonMap::NearestPhoton& a, const PhotonMap::NearestPhoton& b)
+{
+    return a.distanceSquared < b.distanceSquared;
+}
+}
+
+PhotonMap::PhotonMap()
+{
+}
+
+void PhotonMap::Build(std::vector<Photon>& inputPhotons, int numThreads)
+{
+    PROFILE_ZONE("Photon KD-Tree Build");
+    photons.assign(inputPhotons.size(), Photon());
+
+    // Every level spawns one extra thread per subtree, so stop splitting once there are enough subtrees to go around.
+    int parallelDepth = 0;
+    while ((1 << parallelDepth) < numThreads) {
+        ++parallelDepth;
+    }
+
+    BalanceSubtree(inputPhotons.begin(), inputPhotons.end(), 0, parallelDepth);
+    std::vector<Photon>().swap(inputPhotons);
+}
+
+void PhotonMap::BalanceSubtree(std::vector<Photon>::iterator begin, std::vector<Photon>::iterator end, size_t heapIndex, int parallelDepth)
+{
+    const size_t totalNodes = static_cast<size_t>(end - begin);
+    if (totalNodes == 0) {
+        return;
+    }
+
+    // Split along the axis with the largest extent.
+    glm::vec3 minPosition(std::numeric_limits<float>::max());
+    glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+    for (auto it = begin; it != end; ++it) {
+        minPosition = glm::min(minPosition, it->position);
+        maxPosition = glm::max(maxPosition, it->position);
+    }
+    const glm::vec3 extent = maxPosition - minPosition;
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+
+    const auto median = begin + LeftSubtreeSize(totalNodes);
+    std::nth_element(begin, median, end, [axis](const Photon& a, const Photon& b) {
+        return a.position[axis] < b.position[axis];
+    });
+
+    photons[heapIndex] = *median;
+    photons[heapIndex].splitAxis = static_cast<uint8_t>(axis);
+
+    if (parallelDepth > 0) {
+        std::thread leftBuild(&PhotonMap::BalanceSubtree, this, begin, median, 2 * heapIndex + 1, parallelDepth - 1);
+        BalanceSubtree(median + 1, end, 2 * heapIndex + 2, parallelDepth - 1);
+        leftBuild.join();
+    } else {
+        BalanceSubtree(begin, median, 2 * heapIndex + 1, 0);
+        BalanceSubtree(median + 1, end, 2 * heapIndex + 2, 0);
+    }
+}
+
+void PhotonMap::FindWithinRadius(const glm::vec3& position, float radius, std::vector<const Photon*>& output) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::PHOTON_QUERIES);
+    output.clear();
+    if (photons.empty()) {
+        return;
+    }
+    LocateWithinRadius(0, position, radius * radius, output);
+}
+
+void PhotonMap::LocateWithinRadius(size_t heapIndex, const glm::vec3& position, float radiusSquared, std::vector<const Photon*>& output) const
+{
+    const Photon& photon = photons[heapIndex];
+
+    const size_t leftChild = 2 * heapIndex + 1;
+    if (leftChild < photons.size()) {
+        const float planeDistance = position[photon.splitAxis] - photon.position[photon.splitAxis];
+        const size_t nearChild = (planeDistance < 0.f) ? leftChild : leftChild + 1;
+        const size_t farChild = (planeDistance < 0.f) ? leftChild + 1 : leftChild;
+
+        if (nearChild < photons.size()) {
+            LocateWithinRadius(nearChild, position, radiusSquared, output);
+        }
+        if (farChild < photons.size() && planeDistance * planeDistance < radiusSquared) {
+            LocateWithinRadius(farChild, position, radiusSquared, output);
+        }
+    }
+
+    const glm::vec3 offset = photon.position - position;
+    if (glm::dot(offset, offset) <= radiusSquared) {
+        output.push_back(&photon);
+    }
+}
+
+float PhotonMap::FindNearest(const glm::vec3& position, size_t k, float maxRadius, std::vector<NearestPhoton>& output) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::PHOTON_QUERIES);
+    output.clear();
+    if (photons.empty() || k == 0) {
+        return 0.f;
+    }
+
+    float radiusSquared = maxRadius * maxRadius;
+    LocateNearest(0, position, k, radiusSquared, output);
+    return output.empty() ? 0.f : output.front().distanceSquared;
+}
+
+void PhotonMap::LocateNearest(size_t heapIndex, const glm::vec3& position, size_t k, float& radiusSquared, std::vector<NearestPhoton>& output) const
+{
+    const Photon& photon = photons[heapIndex];
+
+    const size_t leftChild = 2 * heapIndex + 1;
+    if (leftChild < photons.size()) {
+        const float planeDistance = position[photon.splitAxis] - photon.position[photon.splitAxis];
+        const size_t nearChild = (planeDistance < 0.f) ? leftChild : leftChild + 1;
+        const size_t farChild = (planeDistance < 0.f) ? leftChild + 1 : leftChild;
+
+        if (nearChild < photons.size()) {
+            LocateNearest(nearChild, position, k, radiusSquared, output);
+        }
+        // radiusSquared shrinks once the heap is full, so re-check it after visiting the near side.
+        if (farChild < photons.size() && planeDistance * planeDistance < radiusSquared) {
+            LocateNearest(farChild, position, k, radiusSquared, output);
+        }
+    }
+
+    const glm::vec3 offset = photon.position - position;
+    const float distanceSquared = glm::dot(offset, offset);
+    if (distanceSquared > radiusSquared) {
+        return;
+    }
+
+    if (output.size() == k) {
+        std::pop_heap(output.begin(), output.end(), CompareNearest);
+        output.pop_back();
+    }
+
+    NearestPhoton nearest;
+    nearest.distanceSquared = distanceSquared;
+    nearest.photon = &photon;
+    output.push_back(nearest);
+    std::push_heap(output.begin(), output.end(), CompareNearest);
+
+    if (output.size() == k) {
+        radiusSquared = output.front().distanceSquared;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Rendering/Renderer/Photon/Photon.h"
+
+// Static photon kd-tree in the style of Jensen's balanced photon map. The tree is built once and stored as a
+// left-balanced implicit heap: the children of node i live at 2i + 1 and 2i + 2, so there are no per-node
+// allocations or child pointers and the top of the tree stays hot in cache.
+class PhotonMap
+{
+public:
+    struct NearestPhoton
+    {
+        float distanceSquared;
+        const Photon* photon;
+    };
+
+    PhotonMap();
+
+    // Replaces the contents of the map with the input photons, which are consumed. Subtrees near the root are
+    // balanced on separate threads.
+    void Build(std::vector<Photon>& inputPhotons, int numThreads = 1);
+
+    // Fills output with every photon within radius of position. Output is cleared first and can be reused across calls.
+    void FindWithinRadius(const glm::vec3& position, float radius, std::vector<const Photon*>& output) const;
+
+    // Fills output with up to k photons closest to position that are no farther than maxRadius, kept as a max-heap on
+    // distanceSquared. Returns the squared distance to the farthest photon found, or 0 if nothing was found.
+    float FindNearest(const glm::vec3& position, size_t k, float maxRadius, std::vector<NearestPhoton>& output) const;
+
+    size_t GetTotalPhotons() const { return photons.size(); }
+    bool IsEmpty() const { return photons.empty(); }
+    const std::vector<Photon>& GetPhotons() const { return photons; }
+
+private:
+    void BalanceSubtree(std::vector<Photon>::iterator begin, std::vector<Photon>::iterator end, size_t heapIndex, int parallelDepth);
+
+    void LocateWithinRadius(size_t heapIndex, const glm::vec3& position, float radiusSquared, std::vector<const Photon*>& output) const;
+    void LocateNearest(size_t heapIndex, const glm::vec3& position, size_t k, float& radiusSquared, std::vector<NearestPhoton>& output) const;
+
+    std::vector<Photon> photons;
+};
@@ -10,57 +10,201 @@
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
 #include "glm/gtx/component_wise.hpp"
+#include <atomic>
 
 #define VISUALIZE_PHOTON_MAPPING 0
 #define DIRECT_VISUALIZATION 0
 #define WITHOUT_CAUSTICS 0
 
+namespace
+{
+// Photons per emission chunk: enough to make handing out chunks cheap, few enough to keep the threads balanced.
+const int PHOTON_CHUNK_SIZE = 1024;
+}
 
 PhotonMappingRenderer::PhotonMappingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler):
     BackwardRenderer(scene, sampler), 
     diffusePhotonNumber(300000), // 2000000
 	causticPhotonNumber(500000), // 100000
     maxPhotonBounces(10), // 1000
-	gatherSamplesNumber(64)
+	gatherSamplesNumber(64),
+	diffuseGatherRadius(0.03f),
+	causticGatherRadius(0.015f),
+	photonThreadsNumber(0),
+	irradianceCacheAccuracy(0.f),
+	radiancePhotonSpacing(0)
+{
+	gatherSampler = std::make_shared<ColorSampler>();
+}
+
+int PhotonMappingRenderer::GetPhotonThreadCount() const
 {
-    srand(static_cast<unsigned int>(time(NULL)));
+	return (photonThreadsNumber > 0) ? photonThreadsNumber : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
 }
 
 void PhotonMappingRenderer::InitializeRenderer()
 {
+	const int numThreads = GetPhotonThreadCount();
+	PhotonBuffer photons;
+
     // Generate Photon Maps
-	GenericPhotonMapGeneration(diffusePhotonNumber, 36.f, false);
+	GenericPhotonMapGeneration(diffusePhotonNumber, 36.f, false, 0, numThreads, photons);
 #if !WITHOUT_CAUSTICS
-	GenericPhotonMapGeneration(causticPhotonNumber, 1.f, false);
+	GenericPhotonMapGeneration(causticPhotonNumber, 1.f, false, 1, numThreads, photons);
 #endif
 
-    diffuseMap.optimise();
-	causticMap.optimise();
+	BuildPhotonMaps(photons, numThreads);
+	PrecomputeRadiancePhotons(numThreads);
+
+	// Size the irradiance cache after the region the photons reached.
+	glm::vec3 minBounds(std::numeric_limits<float>::max());
+	glm::vec3 maxBounds(std::numeric_limits<float>::lowest());
+	for (const PhotonMap* photonMap : { &diffuseMap, &causticMap })
+	{
+		for (const Photon& photon : photonMap->GetPhotons())
+		{
+			minBounds = glm::min(minBounds, photon.position);
+			maxBounds = glm::max(maxBounds, photon.position);
+		}
+	}
+	if (diffuseMap.IsEmpty() && causticMap.IsEmpty())
+	{
+		minBounds = glm::vec3(-1.f);
+		maxBounds = glm::vec3(1.f);
+	}
+	const float sceneSize = glm::length(maxBounds - minBounds);
+	irradianceCache.Reset(minBounds, maxBounds, irradianceCacheAccuracy, 0.001f * sceneSize, 0.1f * sceneSize);
+}
+
+void PhotonMappingRenderer::BuildPhotonMaps(PhotonBuffer& photons, int numThreads)
+{
+	diffuseMap.Build(photons.diffuse, numThreads);
+	causticMap.Build(photons.caustic, numThreads);
+	photons = PhotonBuffer();
 }
 
-float PhotonMappingRenderer::SampleRangeLess(const float x, const float y) const
+void PhotonMappingRenderer::PrecomputeRadiancePhotons(int numThreads)
 {
-	assert(x < y);
+	PROFILE_ZONE("Radiance Photon Precompute");
+	std::vector<Photon> radiancePhotons;
+	if (radiancePhotonSpacing <= 0)
+	{
+		radianceMap.Build(radiancePhotons);
+		return;
+	}
+
+	const std::vector<Photon>& diffusePhotons = diffuseMap.GetPhotons();
+	radiancePhotons.resize((diffusePhotons.size() + radiancePhotonSpacing - 1) / radiancePhotonSpacing);
+
+	// Each radiance photon is independent, so the threads just take contiguous slices.
+	auto computeRange = [&](size_t begin, size_t end) {
+		std::vector<PhotonMap::NearestPhoton> nearestPhotons;
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Photon& source = diffusePhotons[i * radiancePhotonSpacing];
+			const glm::vec3 normal = source.GetNormal();
 
-	std::random_device rd;
-	std::mt19937 mt(rd());
-	std::uniform_real_distribution<float> dist(x, y);
+			const float maxDistanceSquared = diffuseMap.FindNearest(source.position, 200, diffuseGatherRadius, nearestPhotons);
+			const float radiusSquared = (nearestPhotons.size() == 200 && maxDistanceSquared > 0.f) ? maxDistanceSquared : diffuseGatherRadius * diffuseGatherRadius;
 
-	return dist(mt);
+			glm::vec3 irradiance;
+			for (const PhotonMap::NearestPhoton& nearest : nearestPhotons)
+			{
+				const Photon& photon = *nearest.photon;
+				if (std::abs(std::abs(glm::dot(photon.GetNormal(), normal)) - 1.f) > 1000.f * LARGE_EPSILON)
+					continue;
+				irradiance += photon.GetPower() * std::max(glm::dot(normal, photon.GetDirection()), 0.f);
+			}
+
+			Photon& output = radiancePhotons[i];
+			output.position = source.position;
+			output.normal[0] = source.normal[0];
+			output.normal[1] = source.normal[1];
+			output.SetPower(irradiance / (PI * radiusSquared));
+		}
+	};
+
+	std::vector<std::thread> workers;
+	const size_t totalRadiancePhotons = radiancePhotons.size();
+	for (int t = 1; t < numThreads; ++t)
+	{
+		workers.push_back(std::thread(computeRange, totalRadiancePhotons * t / numThreads, totalRadiancePhotons * (t + 1) / numThreads));
+	}
+	computeRange(0, totalRadiancePhotons / numThreads);
+
+	for (auto& t : workers)
+	{
+		t.join();
+	}
+
+	radianceMap.Build(radiancePhotons, numThreads);
+}
+
+glm::vec3 PhotonMappingRenderer::LookupRadiancePhoton(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const
+{
+	const glm::vec3 intersectionPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+	const glm::vec3 N = intersection.ComputeNormal();
+
+	// Take the closest of a few candidates whose normal agrees with the surface.
+	thread_local std::vector<PhotonMap::NearestPhoton> nearestPhotons;
+	radianceMap.FindNearest(intersectionPoint, 4, diffuseGatherRadius, nearestPhotons);
+
+	const Photon* closest = nullptr;
+	float closestDistanceSquared = std::numeric_limits<float>::max();
+	for (const PhotonMap::NearestPhoton& nearest : nearestPhotons)
+	{
+		if (nearest.distanceSquared < closestDistanceSquared && glm::dot(nearest.photon->GetNormal(), N) > 0.9f)
+		{
+			closest = nearest.photon;
+			closestDistanceSquared = nearest.distanceSquared;
+		}
+	}
+	if (!closest)
+	{
+		return glm::vec3();
+	}
+
+	// The stored irradiance is already cosine weighted, so apply the diffuse response as if the light arrived along the normal.
+	const Ray normalRay(intersectionPoint, N);
+	const Material* hitMaterial = intersection.intersectedPrimitive->GetParentMeshObject()->GetMaterial();
+	return hitMaterial->ComputeBRDF(intersection, closest->GetPower(), normalRay, fromCameraRay, 1.f, true, false);
+}
+
+float PhotonMappingRenderer::SampleRangeLess(const float x, const float y) const
+{
+	return SampleRangeLess(x, y, RandomGenerator::GetThreadGenerator());
 }
 
 float PhotonMappingRenderer::SampleRange(const float x, const float y) const
+{
+	return SampleRange(x, y, RandomGenerator::GetThreadGenerator());
+}
+
+float PhotonMappingRenderer::SampleRangeLess(const float x, const float y, RandomGenerator& generator) const
 {
 	assert(x < y);
 
-	std::random_device rd;
-	std::mt19937 mt(rd());
-	std::uniform_real_distribution<float> dist(x, std::nextafter(y, FLT_MAX));
+	return x + (y - x) * generator.NextFloat();
+}
+
+float PhotonMappingRenderer::SampleRange(const float x, const float y, RandomGenerator& generator) const
+{
+	assert(x < y);
 
-	return dist(mt);
+	return x + (y - x) * generator.NextFloatClosed();
 }
 
 glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirection() const
+{
+	return SampleHemisphereRayDirection(RandomGenerator::GetThreadGenerator());
+}
+
+glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal) const
+{
+	return SampleHemisphereRayDirectionGlobalSpace(normal, RandomGenerator::GetThreadGenerator());
+}
+
+glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirection(RandomGenerator& generator) const
 {
 	/*
 	float x, y, z;
@@ -79,9 +223,16 @@ glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirection() const
 	return glm::normalize(glm::vec3(x, y, z));
 	*/
 
-	float u = SampleRange(0.f, 1.f);
+	const float u = SampleRange(0.f, 1.f, generator);
+	const float v = SampleRangeLess(0.f, 1.f, generator);
+	return SampleHemisphereRayDirection(glm::vec2(u, v));
+}
+
+glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirection(const glm::vec2& sample) const
+{
+	float u = sample.x;
 	float r = sqrt(u);
-	float theta = 2.f * PI * SampleRangeLess(0.f, 1.f);
+	float theta = 2.f * PI * sample.y;
 
 	float x = r * cos(theta);
 	float y = r * sin(theta);
@@ -90,7 +241,14 @@ glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirection() const
 	return glm::vec3(x, y, z);
 }
 
-glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal) const
+glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal, RandomGenerator& generator) const
+{
+	const float u = SampleRange(0.f, 1.f, generator);
+	const float v = SampleRangeLess(0.f, 1.f, generator);
+	return SampleHemisphereRayDirectionGlobalSpace(normal, glm::vec2(u, v));
+}
+
+glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal, const glm::vec2& sample) const
 {
 	assert(glm::length(normal) > 10.f * LARGE_EPSILON);
 	glm::vec3 norm = glm::normalize(normal); // For safety
@@ -109,14 +267,27 @@ glm::vec3 PhotonMappingRenderer::SampleHemisphereRayDirectionGlobalSpace(const g
 
 	glm::mat3x3 transform = glm::mat3x3(tang, bitang, norm);
 
-	glm::vec3 rayDirection = SampleHemisphereRayDirection();
+	glm::vec3 rayDirection = SampleHemisphereRayDirection(sample);
 	rayDirection = transform * rayDirection;
 
 	return rayDirection;
 }
 
-void PhotonMappingRenderer::GenericPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect)
+void PhotonMappingRenderer::GenericPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect, uint64_t emission, int numThreads, PhotonBuffer& output) const
+{
+	ShootPhotons(totalPhotons, lightingScale, includeDirect, false, emission, numThreads, output);
+}
+
+void PhotonMappingRenderer::CausticPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect, uint64_t emission, int numThreads, PhotonBuffer& output) const
+{
+	ShootPhotons(totalPhotons, lightingScale, includeDirect, true, emission, numThreads, output);
+}
+
+void PhotonMappingRenderer::ShootPhotons(int totalPhotons, float lightingScale, bool includeDirect, bool specularHitsOnly, uint64_t emission, int numThreads, PhotonBuffer& output) const
 {
+	PROFILE_ZONE("Photon Emission");
+	assert(numThreads >= 1);
+
     float totalLightIntensity = 0.f;
     size_t totalLights = storedScene->GetTotalLights();
 
@@ -130,52 +301,15 @@ void PhotonMappingRenderer::GenericPhotonMapGeneration(int totalPhotons, float l
         totalLightIntensity += glm::length(currentLight->GetLightColor());
     }
 
-    // Shoot photons -- number of photons for light is proportional to the light's intensity relative to the total light intensity of the scene.
-    for (size_t i = 0; i < totalLights; ++i) 
-	{
-        const Light* currentLight = storedScene->GetLightObject(i);
-        if (!currentLight) 
-		{
-            continue;
-        }
-
-        const float proportion = glm::length(currentLight->GetLightColor()) / totalLightIntensity;
-        const int totalPhotonsForLight = static_cast<const int>(proportion * totalPhotons);
-
-		if (totalPhotonsForLight > 0)
-		{
-			glm::vec3 photonIntensity = lightingScale * currentLight->GetLightColor() / static_cast<float>(totalPhotonsForLight);
-
-			int photonCount = totalPhotonsForLight;
-			for (int i = 0; i < totalPhotonsForLight; ++i)
-			{
-				Ray photonRay;
-				currentLight->GenerateRandomPhotonRay(photonRay);
-				
-				std::vector<char> path;
-				path.push_back('L');
-				TracePhoton(&photonRay, photonIntensity, path, 1.f, maxPhotonBounces, includeDirect);
-			}
-		}
-    }
-}
-
-void PhotonMappingRenderer::CausticPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect)
-{
-	float totalLightIntensity = 0.f;
-	size_t totalLights = storedScene->GetTotalLights();
-
-	for (size_t i = 0; i < totalLights; ++i)
-	{
-		const Light* currentLight = storedScene->GetLightObject(i);
-		if (!currentLight)
-		{
-			continue;
-		}
-		totalLightIntensity += glm::length(currentLight->GetLightColor());
-	}
-
 	// Shoot photons -- number of photons for light is proportional to the light's intensity relative to the total light intensity of the scene.
+	// Every light's photons are cut into chunks of PHOTON_CHUNK_SIZE, which the threads take in turn.
+	struct PhotonChunk
+	{
+		const Light* light;
+		int photons;
+		glm::vec3 photonIntensity;
+	};
+	std::vector<PhotonChunk> chunks;
 	for (size_t i = 0; i < totalLights; ++i)
 	{
 		const Light* currentLight = storedScene->GetLightObject(i);
@@ -186,45 +320,92 @@ void PhotonMappingRenderer::CausticPhotonMapGeneration(int totalPhotons, float l
 
 		const float proportion = glm::length(currentLight->GetLightColor()) / totalLightIntensity;
 		const int totalPhotonsForLight = static_cast<const int>(proportion * totalPhotons);
-
-		if (totalPhotonsForLight > 0)
+		const glm::vec3 photonIntensity = lightingScale * currentLight->GetLightColor() / static_cast<float>(std::max(totalPhotonsForLight, 1));
+		for (int firstPhoton = 0; firstPhoton < totalPhotonsForLight; firstPhoton += PHOTON_CHUNK_SIZE)
 		{
-			glm::vec3 photonIntensity = lightingScale * currentLight->GetLightColor() / static_cast<float>(totalPhotonsForLight);
+			const PhotonChunk chunk = { currentLight, std::min(PHOTON_CHUNK_SIZE, totalPhotonsForLight - firstPhoton), photonIntensity };
+			chunks.push_back(chunk);
+		}
+	}
 
-			int photonCount = totalPhotonsForLight;
-			for (int i = 0; i < totalPhotonsForLight;)
+	std::vector<PhotonBuffer> chunkOutputs(chunks.size());
+	std::atomic<size_t> nextChunk(0);
+	auto shootPhotonsForThread = [&]() {
+		PROFILE_ZONE("Photon Emission Worker");
+		std::vector<char> path;
+		for (size_t chunkIndex = nextChunk++; chunkIndex < chunks.size(); chunkIndex = nextChunk++)
+		{
+			const PhotonChunk& chunk = chunks[chunkIndex];
+			const Light* currentLight = chunk.light;
+			const glm::vec3 photonIntensity = chunk.photonIntensity;
+			RandomGenerator generator(emission, chunkIndex);
+			PhotonBuffer& output = chunkOutputs[chunkIndex];
+			for (int p = 0; p < chunk.photons;)
 			{
 				Ray photonRay;
-				currentLight->GenerateRandomPhotonRay(photonRay);
+				currentLight->GenerateRandomPhotonRay(photonRay, generator);
 
-				IntersectionState state(0, 0);
-				bool hit = storedScene->Trace(&photonRay, &state);
-				if (!hit)
+				if (specularHitsOnly)
 				{
-					continue;
+					IntersectionState state(0, 0);
+					bool hit = storedScene->Trace(&photonRay, &state);
+					if (!hit)
+					{
+						continue;
+					}
+
+					const MeshObject* hitMeshObject = state.intersectedPrimitive->GetParentMeshObject();
+					const Material* hitMaterial = hitMeshObject->GetMaterial();
+					const float transmittance = hitMaterial->GetTransmittance();
+					const float reflectivity = hitMaterial->GetReflectivity();
+
+					if (transmittance + reflectivity < LARGE_EPSILON)
+					{
+						continue;
+					}
 				}
 
-				const MeshObject* hitMeshObject = state.intersectedPrimitive->GetParentMeshObject();
-				const Material* hitMaterial = hitMeshObject->GetMaterial();
-				const float transmittance = hitMaterial->GetTransmittance();
-				const float reflectivity = hitMaterial->GetReflectivity();
+				++p;
 
-				if (transmittance + reflectivity < LARGE_EPSILON)
-				{
-					continue;
-				}
-
-				++i;
-
-				std::vector<char> path;
+				path.clear();
 				path.push_back('L');
-				TracePhoton(&photonRay, photonIntensity, path, 1.f, maxPhotonBounces, includeDirect);
+				TracePhoton(&photonRay, photonIntensity, path, 1.f, maxPhotonBounces, includeDirect, generator, output);
 			}
 		}
+	};
+
+	// The calling thread shoots photons too, so only spawn the additional workers.
+	std::vector<std::thread> workers;
+	for (int i = 1; i < numThreads; ++i)
+	{
+		workers.push_back(std::thread(shootPhotonsForThread));
+	}
+	shootPhotonsForThread();
+
+	for (auto& t : workers)
+	{
+		t.join();
+	}
+
+	// Merge in chunk order so the result does not depend on which thread shot which chunk.
+	size_t totalDiffuse = output.diffuse.size();
+	size_t totalCaustic = output.caustic.size();
+	for (const PhotonBuffer& chunkOutput : chunkOutputs)
+	{
+		totalDiffuse += chunkOutput.diffuse.size();
+		totalCaustic += chunkOutput.caustic.size();
+	}
+	output.diffuse.reserve(totalDiffuse);
+	output.caustic.reserve(totalCaustic);
+	for (const PhotonBuffer& chunkOutput : chunkOutputs)
+	{
+		output.diffuse.insert(output.diffuse.end(), chunkOutput.diffuse.begin(), chunkOutput.diffuse.end());
+		output.caustic.insert(output.caustic.end(), chunkOutput.caustic.begin(), chunkOutput.caustic.end());
 	}
 }
 
-void PhotonMappingRenderer::TracePhoton(Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces, bool withDirect)
+void PhotonMappingRenderer::TracePhoton(Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces, bool withDirect, 
+										RandomGenerator& generator, PhotonBuffer& output) const
 {
 	if (remainingBounces < 0)
 	{
@@ -246,10 +427,10 @@ void PhotonMappingRenderer::TracePhoton(Ray* photonRay, glm::vec3 lightIntensity
 
 	Photon myPhoton;
 	myPhoton.position = intersectionPoint + LARGE_EPSILON * norm; // Move intersection point above the surface
-	myPhoton.normal = norm;
-	myPhoton.intensity = lightIntensity;
+	myPhoton.SetNormal(norm);
+	myPhoton.SetPower(lightIntensity);
 	glm::vec3 newLigthIntensity = lightIntensity;
-	myPhoton.toLightRay = Ray(intersectionPoint, -photonRay->GetRayDirection());
+	myPhoton.SetDirection(-photonRay->GetRayDirection());
 
 	const MeshObject* hitMeshObject = state.intersectedPrimitive->GetParentMeshObject();
 	const Material* hitMaterial = hitMeshObject->GetMaterial();
@@ -264,7 +445,7 @@ void PhotonMappingRenderer::TracePhoton(Ray* photonRay, glm::vec3 lightIntensity
 	float n2 = hitMaterial->GetIOR();
 	const float NdR = glm::dot(photonRay->GetRayDirection(), norm);
 
-	float rnd = SampleRange(0.f, 1.f);
+	float rnd = SampleRange(0.f, 1.f, generator);
 	if (transmittance + reflectivity > LARGE_EPSILON)
 	{
 		if (rnd <= transmittance)
@@ -303,13 +484,13 @@ void PhotonMappingRenderer::TracePhoton(Ray* photonRay, glm::vec3 lightIntensity
 
 		if (path[path.size() - 1] == 'S')
 		{
-			causticMap.insert(myPhoton);
+			output.caustic.push_back(myPhoton);
 	//		diffuseMap.insert(myPhoton); // debug
 		}
 		else
 		{
 			if (path.size() > 1 || withDirect)
-				diffuseMap.insert(myPhoton);
+				output.diffuse.push_back(myPhoton);
 		}
 		path.push_back('D');
 
@@ -341,14 +522,14 @@ void PhotonMappingRenderer::TracePhoton(Ray* photonRay, glm::vec3 lightIntensity
 			return;
 		}
 
-		glm::vec3 rayDirection = SampleHemisphereRayDirectionGlobalSpace(norm);
+		glm::vec3 rayDirection = SampleHemisphereRayDirectionGlobalSpace(norm, generator);
 
 		outputRay.SetRayPosition(intersectionPoint);
 		outputRay.SetRayDirection(rayDirection);
 	}
 
 	--remainingBounces;
-	TracePhoton(&outputRay, newLigthIntensity, path, n2, remainingBounces);
+	TracePhoton(&outputRay, newLigthIntensity, path, n2, remainingBounces, true, generator, output);
 }
 
 void PhotonMappingRenderer::SetNumberOfDiffusePhotons(int diffuse)
@@ -366,17 +547,35 @@ void PhotonMappingRenderer::SetNumberOfGatherSamples(int samplesNumber)
 	gatherSamplesNumber = samplesNumber;
 }
 
+void PhotonMappingRenderer::SetGatherSampler(std::shared_ptr<ColorSampler> sampler)
+{
+	assert(sampler);
+	gatherSampler = std::move(sampler);
+}
+
+void PhotonMappingRenderer::SetNumberOfPhotonThreads(int threads)
+{
+	photonThreadsNumber = std::max(threads, 0);
+}
+
+void PhotonMappingRenderer::SetIrradianceCacheAccuracy(float accuracy)
+{
+	irradianceCacheAccuracy = std::max(accuracy, 0.f);
+}
+
+void PhotonMappingRenderer::SetRadiancePhotonSpacing(int spacing)
+{
+	radiancePhotonSpacing = std::max(spacing, 0);
+}
+
 glm::vec3 PhotonMappingRenderer::CalculateColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay, 
-												const PhotonKdtree& photonMap, float radius, int n, bool useConeFilter) const
+												const PhotonMap& photonMap, float radius, int n, bool useConeFilter) const
 {
 	glm::vec3 addColor = glm::vec3();
 
 #if VISUALIZE_PHOTON_MAPPING
-	Photon intersectionVirtualPhoton;
-	intersectionVirtualPhoton.position = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
-
-	std::vector<Photon> foundPhotons;
-	diffuseMap.find_within_range(intersectionVirtualPhoton, radius, std::back_inserter(foundPhotons)); // 0.003f
+	std::vector<const Photon*> foundPhotons;
+	diffuseMap.FindWithinRadius(intersection.intersectionRay.GetRayPosition(intersection.intersectionT), radius, foundPhotons); // 0.003f
 	if (!foundPhotons.empty())
 	{
 		addColor += glm::vec3(0.f, 0.0f, 0.55f); // glm::vec3(1.f, 0.f, 0.f);
@@ -386,87 +585,43 @@ glm::vec3 PhotonMappingRenderer::CalculateColor(const struct IntersectionState&
 	if (intersection.hasIntersection)
 	{
 		glm::vec3 intersectionPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
-		Photon intersectionVirtualPhoton;
-		intersectionVirtualPhoton.position = intersectionPoint;
 
-		std::vector<Photon> foundPhotons;
-		photonMap.find_within_range(intersectionVirtualPhoton, radius, std::back_inserter(foundPhotons));
-		if (foundPhotons.size() == 0)
+		// Gather the n nearest photons -- radius only caps the search, it shrinks to the n-th photon as the heap fills.
+		thread_local std::vector<PhotonMap::NearestPhoton> nearestPhotons;
+		const float maxDistanceSquared = photonMap.FindNearest(intersectionPoint, static_cast<size_t>(n), radius, nearestPhotons);
+		if (nearestPhotons.empty())
 			return addColor;
-#if 0
-		if (foundPhotons.size() > 3 * n)
-		{
-			std::sort(foundPhotons.begin(), foundPhotons.end(), [intersectionPoint](Photon a, Photon b)
-			{
-				return glm::dot(a.position - intersectionPoint, a.position - intersectionPoint) < dot(b.position - intersectionPoint, b.position - intersectionPoint);
-			});
 
-			//	std::cout << "Radius = " << radius << " Photons found = " << foundPhotons.size() << std::endl;
-//			radius *= 0.5f;
-//			photonMap.find_within_range(intersectionVirtualPhoton, radius, std::back_inserter(foundPhotons));
+		// A full heap means the photons only cover the disc out to the n-th nearest one.
+		float r = radius;
+		if (nearestPhotons.size() == static_cast<size_t>(n) && maxDistanceSquared > 0.f)
+		{
+			r = std::sqrt(maxDistanceSquared);
 		}
-#endif
+		const float area = PI * r * r;
+
 		const MeshObject* hitMeshObject = intersection.intersectedPrimitive->GetParentMeshObject();
 		const Material* hitMaterial = hitMeshObject->GetMaterial();
+		const glm::vec3 N = intersection.ComputeNormal();
 
-		float area = PI * radius * radius;
-
-		float r = radius;				// temp
-		int count = 0;
-		float minArea = 0.f;
-		for (int i = 0; i < foundPhotons.size(); ++i)
+		for (const PhotonMap::NearestPhoton& nearest : nearestPhotons)
 		{
-			Photon photon = foundPhotons[i];
-
-			const glm::vec3 N = intersection.ComputeNormal();
-			if (std::abs(std::abs(glm::dot(photon.normal, N)) - 1.f) > 1000.f * LARGE_EPSILON)
-				continue;
-
-			glm::vec3 brdfColor = hitMaterial->ComputeBRDF(intersection, photon.intensity, photon.toLightRay, fromCameraRay, 1.f, true, true);
-
-			float modV = glm::length(brdfColor);
-			float maxC = std::max(std::abs(brdfColor.x), std::max(std::abs(brdfColor.y), std::abs(brdfColor.z)));
-
-			if (modV > SMALL_EPSILON)
-			{
-				float scale = 1.5f * maxC / modV; // 3.f
-				scale = 1.f; // Testing
-				brdfColor = brdfColor * scale;
-			}
-
-			float distSqr = glm::dot(intersectionPoint - photon.position, intersectionPoint - photon.position);
-			float dist = sqrt(distSqr); // square to sphere
-			if (dist > radius)
+			const Photon& photon = *nearest.photon;
+			if (std::abs(std::abs(glm::dot(photon.GetNormal(), N)) - 1.f) > 1000.f * LARGE_EPSILON)
 				continue;
 
-			minArea = PI * distSqr > minArea ? PI * distSqr : minArea;
-
-			count++;
-			float noweight = 1.f;
-
-			// Cone filter
-			float k = 1;
-			float norm = 1.f - 2.f / (3.f * k);
-			float weight = 1.f / norm * (1.f - k * dist / r);
+			const Ray toLightRay(photon.position, photon.GetDirection());
+			glm::vec3 brdfColor = hitMaterial->ComputeBRDF(intersection, photon.GetPower(), toLightRay, fromCameraRay, 1.f, true, true);
 
-			// Gauss filter
-			float alpha = 0.918;
-			float beta = 1.953;
-			//	float gaussW = alpha * (1.f - (1.f - pow(e())/());
-
-			if (!useConeFilter)
+			float weight = 1.f;
+			if (useConeFilter)
 			{
-				weight = noweight;
+				// Cone filter
+				const float k = 1.f;
+				const float norm = 1.f - 2.f / (3.f * k);
+				weight = 1.f / norm * (1.f - k * std::sqrt(nearest.distanceSquared) / r);
 			}
 			addColor += weight * brdfColor;
-#if 0
-			if (count > n)
-			{
-				if (minArea > SMALL_EPSILON && minArea < area)
-					area = minArea;
-				break;
-			}
-#endif
 		}
 
 		addColor /= area;
@@ -495,8 +650,8 @@ glm::vec3 PhotonMappingRenderer::ComputeSampleColor(const struct IntersectionSta
 	// Debug
 //	glm::vec3 finalRenderColor = glm::vec3(); 
 
-	float diffuseRadius = 0.03;
-	float causticRadius = 0.015;
+	const float diffuseRadius = diffuseGatherRadius;
+	const float causticRadius = causticGatherRadius;
 
 #if VISUALIZE_PHOTON_MAPPING
 	return finalRenderColor + CalculateColor(intersection, fromCameraRay, diffuseMap, 0.007, 100);
@@ -514,36 +669,71 @@ glm::vec3 PhotonMappingRenderer::ComputeSampleColor(const struct IntersectionSta
 	// Debug
 //	return finalRenderColor;
 
-	glm::vec3 normal = intersection.ComputeNormal();
-	glm::vec3 hitPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+	const glm::vec3 gatheredIrradiance = ComputeGatherIrradiance(intersection, diffuseRadius);
+
+	// The gather is already cosine weighted, so apply the diffuse response as if the light arrived along the normal.
+	const glm::vec3 hitPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+	const Ray normalRay(hitPoint, intersection.ComputeNormal());
+	const Material* hitMaterial = intersection.intersectedPrimitive->GetParentMeshObject()->GetMaterial();
+	finalRenderColor += hitMaterial->ComputeBRDF(intersection, gatheredIrradiance, normalRay, fromCameraRay, 1.f, true, false);
+
+	return finalRenderColor;
+}
+
+glm::vec3 PhotonMappingRenderer::ComputeGatherIrradiance(const struct IntersectionState& intersection, float diffuseRadius) const
+{
+	const glm::vec3 normal = intersection.ComputeNormal();
+	const glm::vec3 hitPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+
+	const bool useCache = irradianceCacheAccuracy > 0.f;
+	glm::vec3 irradiance;
+	if (useCache && irradianceCache.Lookup(hitPoint, normal, irradiance))
+	{
+		return irradiance;
+	}
+
+	ScopedSamplerState scopedGatherState(*gatherSampler.get(), RandomGenerator::GetThreadGenerator(), std::max(gatherSamplesNumber, 1), 2);
+	SamplerState& gatherState = scopedGatherState.Get();
+	float inverseDistanceSum = 0.f;
 	for (int i = 0; i < gatherSamplesNumber; ++i)
 	{
-		glm::vec3 sampleDir = SampleHemisphereRayDirectionGlobalSpace(normal);
+		const glm::vec3 sample = gatherSampler->ComputeSampleCoordinate(gatherState);
+		++gatherState.samplesComputed;
+		glm::vec3 sampleDir = SampleHemisphereRayDirectionGlobalSpace(normal, glm::vec2(sample));
 
 		Ray sampleRay;
 		sampleRay.SetRayDirection(sampleDir);
 		sampleRay.SetRayPosition(hitPoint + LARGE_EPSILON * normal);
 
-		// Fix! storedApplication->GetMaxReflectionBounces(), storedApplication->GetMaxRefractionBounces()
-		IntersectionState sampleIntersection(2, 4); // 2, 4
+		// Only the first hit matters for the photon lookup.
+		DIAGNOSTICS_STAT(DiagnosticsType::GATHER_RAYS);
+		IntersectionState sampleIntersection(0, 0);
 		bool didHitScene = storedScene->Trace(&sampleRay, &sampleIntersection);
-
-		// Use the intersection data to compute the BRDF response.
 		if (!didHitScene)
 		{
 			continue;
 		}
 
-		glm::vec3 intersectionPoint = sampleIntersection.intersectionRay.GetRayPosition(intersection.intersectionT);
-		glm::vec3 sampleColor = CalculateColor(intersection, fromCameraRay, diffuseMap, diffuseRadius, 200);
-
-		const MeshObject* hitMeshObject = sampleIntersection.intersectedPrimitive->GetParentMeshObject();
-		const Material* hitMaterial = hitMeshObject->GetMaterial();
-
-		glm::vec3 brdfColor = hitMaterial->ComputeBRDF(intersection, sampleColor, sampleRay, fromCameraRay, 1.f, true, true);
-
-		finalRenderColor += brdfColor / static_cast<float>(gatherSamplesNumber);
+		inverseDistanceSum += 1.f / std::max(sampleIntersection.intersectionT, SMALL_EPSILON);
+		if (radianceMap.IsEmpty())
+		{
+			irradiance += CalculateColor(sampleIntersection, sampleRay, diffuseMap, diffuseRadius, 200);
+		}
+		else
+		{
+			irradiance += LookupRadiancePhoton(sampleIntersection, sampleRay);
+		}
+	}
+	if (gatherSamplesNumber > 0)
+	{
+		irradiance /= static_cast<float>(gatherSamplesNumber);
 	}
 
-	return finalRenderColor;
+	if (useCache)
+	{
+		// Rays that escaped the scene count as infinitely far away.
+		const float harmonicMeanDistance = (inverseDistanceSum > 0.f) ? static_cast<float>(gatherSamplesNumber) / inverseDistanceSum : std::numeric_limits<float>::max();
+		irradianceCache.Insert(hitPoint, normal, irradiance, harmonicMeanDistance);
+	}
+	return irradiance;
 }
\ No newline at end of file
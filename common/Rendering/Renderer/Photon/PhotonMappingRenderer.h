@@ -2,7 +2,9 @@
 
 #include "common/Rendering/Renderer.h"
 #include "common/Rendering/Renderer/Photon/Photon.h"
-#include <kdtree++/kdtree.hpp>
+#include "common/Rendering/Renderer/Photon/PhotonMap.h"
+#include "common/Rendering/Renderer/Photon/IrradianceCache.h"
+#include "common/Sampling/Random/RandomGenerator.h"
 #include <functional>
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Renderer/Backward/BackwardRenderer.h"
@@ -17,21 +19,53 @@ public:
     void SetNumberOfDiffusePhotons(int diffuse);
 	void SetNumberOfCausticPhotons(int caustic);
 	void SetNumberOfGatherSamples(int samples);
+	// 0 uses all hardware threads. The photons shot are the same for any thread count.
+	void SetNumberOfPhotonThreads(int threads);
+	// Ward's accuracy parameter for the final-gather irradiance cache, e.g. 0.2. 0, the default, disables the cache and
+	// gathers at every hit. Records are filled by whichever thread gets there first, so a cached image depends on thread timing.
+	void SetIrradianceCacheAccuracy(float accuracy);
+	// Precompute irradiance at every n-th diffuse photon so gather rays need a single lookup, e.g. 4. 0, the default,
+	// disables it. This is an approximation: the lookup applies only the diffuse response of the surface a gather ray
+	// hits, while the full estimate also includes its specular response to each photon.
+	void SetRadiancePhotonSpacing(int spacing);
+	// Sampler for the final-gather directions, uniform random by default.
+	void SetGatherSampler(std::shared_ptr<class ColorSampler> sampler);
 
 	float SampleRangeLess(const float x, const float y) const;
 	float SampleRange(const float x, const float y) const;
+	float SampleRangeLess(const float x, const float y, RandomGenerator& generator) const;
+	float SampleRange(const float x, const float y, RandomGenerator& generator) const;
 
 	glm::vec3 SampleHemisphereRayDirection() const;
 	glm::vec3 SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal) const;
+	glm::vec3 SampleHemisphereRayDirection(RandomGenerator& generator) const;
+	glm::vec3 SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal, RandomGenerator& generator) const;
+	// Cosine-weighted mapping of a point in the unit square onto the hemisphere.
+	glm::vec3 SampleHemisphereRayDirection(const glm::vec2& sample) const;
+	glm::vec3 SampleHemisphereRayDirectionGlobalSpace(const glm::vec3& normal, const glm::vec2& sample) const;
+
+protected:
+	// Photons stored by emission, in the order they were shot.
+	struct PhotonBuffer
+	{
+		std::vector<Photon> diffuse;
+		std::vector<Photon> caustic;
+	};
+
+	int GetPhotonThreadCount() const;
+	// Shoots the photons in fixed-size chunks on numThreads threads and appends them to output in chunk order. Chunk c
+	// draws from stream c of seed emission, so the photons depend on emission but not on the thread count.
+	void ShootPhotons(int totalPhotons, float lightingScale, bool includeDirect, bool specularHitsOnly, uint64_t emission, int numThreads, PhotonBuffer& output) const;
 
 private:
-	using PhotonKdtree = KDTree::KDTree<3, Photon, PhotonAccessor>;
 	glm::vec3 CalculateColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay, 
-							const PhotonKdtree& photonMap, float radius, int n, bool useConeFilter = false) const;
+							const PhotonMap& photonMap, float radius, int n, bool useConeFilter = false) const;
 
-	PhotonKdtree diffuseMap;
-	PhotonKdtree causticMap;
-	PhotonKdtree volumeMap;
+	PhotonMap diffuseMap;
+	PhotonMap causticMap;
+	PhotonMap volumeMap;
+	// Christensen's radiance photons: a subset of the diffuse photons whose power holds the precomputed irradiance.
+	PhotonMap radianceMap;
 
     int diffusePhotonNumber;
 	int causticPhotonNumber;
@@ -39,12 +73,32 @@ private:
     int maxPhotonBounces;
 
 	int gatherSamplesNumber;
+	std::shared_ptr<class ColorSampler> gatherSampler;
+
+	float diffuseGatherRadius;
+	float causticGatherRadius;
+
+	int photonThreadsNumber;
+
+	float irradianceCacheAccuracy;
+	mutable IrradianceCache irradianceCache;
+
+	int radiancePhotonSpacing;
+
+	void PrecomputeRadiancePhotons(int numThreads);
+	// Diffuse radiance leaving the hit point, taken from the nearest radiance photon.
+	glm::vec3 LookupRadiancePhoton(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const;
+
+	// Cosine-weighted average of the indirect radiance arriving at the hit point, i.e. irradiance / pi.
+	glm::vec3 ComputeGatherIrradiance(const struct IntersectionState& intersection, float diffuseRadius) const;
 
 	glm::vec3 ComputeGatherColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay, 
 								const float diffuseRadius = 0.01, const float specularRadius = 0.002) const;
 
-	void GenericPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect);
-	void CausticPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect = false);
+	void GenericPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect, uint64_t emission, int numThreads, PhotonBuffer& output) const;
+	void CausticPhotonMapGeneration(int totalPhotons, float lightingScale, bool includeDirect, uint64_t emission, int numThreads, PhotonBuffer& output) const;
+	void BuildPhotonMaps(PhotonBuffer& photons, int numThreads);
 
-    void TracePhoton(Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces, bool withDirect = true);
+    void TracePhoton(Ray* photonRay, glm::vec3 lightIntensity, std::vector<char>& path, float currentIOR, int remainingBounces, bool withDirect, 
+					RandomGenerator& generator, PhotonBuffer& output) const;
 };
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "common/Rendering/Renderer/Progressive/ProgressivePhotonMappingRenderer.h"
+#include "common/Scene/Geometry/Primitives/Primitive.h"
+#include "common/Scene/Geometry/Mesh/MeshObject.h"
+#include "common/Rendering/Material/Material.h"
+#include "common/Intersection/IntersectionState.h"
+#include "common/Output/ImageWriter.h"
+#include <chrono>
+#include <atomic>
+
+namespace
+{
+std::atomic<uint64_t> nextRenderIndex(1);
+
+// Pixel currently being shaded on this thread, set through BeginPixel.
+thread_local glm::ivec2 currentPixel;
+}
+
+thread_local uint64_t ProgressivePhotonMappingRenderer::threadRenderIndex = 0;
+thread_local ProgressivePhotonMappingRenderer::ThreadVisiblePoints* ProgressivePhotonMappingRenderer::threadPoints = nullptr;
+
+ProgressivePhotonMappingRenderer::ProgressivePhotonMappingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler):
+    PhotonMappingRenderer(scene, sampler),
+    photonsPerPass(100000),
+    maxPasses(64),
+    timeBudget(0.f),
+    initialRadius(0.05f),
+    radiusReduction(0.7f),
+    photonPowerScale(1.f),
+    renderIndex(nextRenderIndex++),
+    gridCellSize(1.f)
+{
+}
+
+void ProgressivePhotonMappingRenderer::InitializeRenderer()
+{
+    // Photons are traced in RefineImage, once the visible points are known.
+    std::lock_guard<std::mutex> lock(threadPointsMutex);
+    threadVisiblePoints.clear();
+    visiblePoints.clear();
+    renderIndex = nextRenderIndex++;
+}
+
+ProgressivePhotonMappingRenderer::ThreadVisiblePoints& ProgressivePhotonMappingRenderer::GetThreadVisiblePoints() const
+{
+    if (threadRenderIndex != renderIndex)
+    {
+        std::lock_guard<std::mutex> lock(threadPointsMutex);
+        threadVisiblePoints.push_back(make_unique<ThreadVisiblePoints>());
+        threadPoints = threadVisiblePoints.back().get();
+        threadRenderIndex = renderIndex;
+    }
+    return *threadPoints;
+}
+
+void ProgressivePhotonMappingRenderer::MergeThreadVisiblePoints()
+{
+    std::lock_guard<std::mutex> lock(threadPointsMutex);
+    std::vector<std::pair<glm::ivec2, int>> pixelSamples;
+    for (const std::unique_ptr<ThreadVisiblePoints>& threadData : threadVisiblePoints)
+    {
+        visiblePoints.insert(visiblePoints.end(), threadData->points.begin(), threadData->points.end());
+        pixelSamples.insert(pixelSamples.end(), threadData->pixelSamples.begin(), threadData->pixelSamples.end());
+    }
+    threadVisiblePoints.clear();
+    renderIndex = nextRenderIndex++;
+
+    // Which thread shaded a pixel depends on scheduling; ordering by pixel keeps the refinement independent of it.
+    auto pixelLess = [](const glm::ivec2& a, const glm::ivec2& b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    };
+    std::stable_sort(visiblePoints.begin(), visiblePoints.end(), [&](const VisiblePoint& a, const VisiblePoint& b) {
+        return pixelLess(a.pixel, b.pixel);
+    });
+    std::sort(pixelSamples.begin(), pixelSamples.end(), [&](const std::pair<glm::ivec2, int>& a, const std::pair<glm::ivec2, int>& b) {
+        return pixelLess(a.first, b.first);
+    });
+
+    // Each visible point is one of the pixel's samples, so it carries 1 / samples of the pixel. If a pixel reported
+    // more than once the largest count is the one its color was averaged over.
+    size_t nextSamples = 0;
+    for (VisiblePoint& point : visiblePoints)
+    {
+        while (nextSamples < pixelSamples.size() && pixelLess(pixelSamples[nextSamples].first, point.pixel))
+        {
+            ++nextSamples;
+        }
+        int samplesTaken = 1;
+        for (size_t i = nextSamples; i < pixelSamples.size() && pixelSamples[i].first == point.pixel; ++i)
+        {
+            samplesTaken = std::max(samplesTaken, pixelSamples[i].second);
+        }
+        point.diffuseResponse /= static_cast<float>(samplesTaken);
+    }
+}
+
+void ProgressivePhotonMappingRenderer::BeginPixel(const glm::ivec2& pixel) const
+{
+    currentPixel = pixel;
+}
+
+void ProgressivePhotonMappingRenderer::EndPixel(const glm::ivec2& pixel, int samplesTaken) const
+{
+    GetThreadVisiblePoints().pixelSamples.push_back(std::make_pair(pixel, samplesTaken));
+}
+
+glm::vec3 ProgressivePhotonMappingRenderer::ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const
+{
+    if (!intersection.hasIntersection)
+    {
+        return glm::vec3();
+    }
+
+    const glm::vec3 sampleColor = BackwardRenderer::ComputeSampleColor(intersection, fromCameraRay);
+
+    // Reflection and refraction rays are shaded through here as well, so a sample seen in a mirror or through glass
+    // records its visible point on the diffuse surface behind it. The surface's color reaches the pixel scaled by the
+    // reflectivities and transmittances along the way and by any Russian roulette boost, which is what pathThroughput
+    // holds. Purely specular surfaces have no diffuse response and only pass their rays on.
+    const glm::vec3 hitPoint = intersection.intersectionRay.GetRayPosition(intersection.intersectionT);
+    const glm::vec3 normal = intersection.ComputeNormal();
+    const Ray normalRay(hitPoint, normal);
+    const Material* hitMaterial = intersection.intersectedPrimitive->GetParentMeshObject()->GetMaterial();
+    const glm::vec3 diffuseResponse = intersection.pathThroughput * hitMaterial->ComputeBRDF(intersection, glm::vec3(1.f), normalRay, fromCameraRay, 1.f, true, false);
+    if (glm::length(diffuseResponse) > SMALL_EPSILON)
+    {
+        VisiblePoint point;
+        point.position = hitPoint;
+        point.normal = normal;
+        point.diffuseResponse = diffuseResponse;
+        point.pixel = currentPixel;
+        point.radiusSquared = initialRadius * initialRadius;
+        point.photonCount = 0.f;
+        GetThreadVisiblePoints().points.push_back(point);
+    }
+    return sampleColor;
+}
+
+int ProgressivePhotonMappingRenderer::ComputeCellHash(const glm::ivec3& cell) const
+{
+    const uint32_t hash = (static_cast<uint32_t>(cell.x) * 73856093u) ^ (static_cast<uint32_t>(cell.y) * 19349663u) ^ (static_cast<uint32_t>(cell.z) * 83492791u);
+    return static_cast<int>(hash % static_cast<uint32_t>(gridStarts.size() - 1));
+}
+
+template<typename Visitor>
+void ProgressivePhotonMappingRenderer::VisitOverlappedCells(const VisiblePoint& point, Visitor visit) const
+{
+    const float radius = std::sqrt(point.radiusSquared);
+    const glm::ivec3 minCell(glm::floor((point.position - radius) / gridCellSize));
+    const glm::ivec3 maxCell(glm::floor((point.position + radius) / gridCellSize));
+    for (int z = minCell.z; z <= maxCell.z; ++z)
+        for (int y = minCell.y; y <= maxCell.y; ++y)
+            for (int x = minCell.x; x <= maxCell.x; ++x)
+                visit(ComputeCellHash(glm::ivec3(x, y, z)));
+}
+
+void ProgressivePhotonMappingRenderer::BuildVisiblePointGrid()
+{
+    float maxRadiusSquared = 0.f;
+    for (const VisiblePoint& point : visiblePoints)
+    {
+        maxRadiusSquared = std::max(maxRadiusSquared, point.radiusSquared);
+    }
+
+    // With cells twice as wide as the largest radius every point overlaps at most eight cells, and a photon only has to
+    // look in the cell it falls into.
+    gridCellSize = std::max(2.f * std::sqrt(maxRadiusSquared), SMALL_EPSILON);
+    gridStarts.assign(visiblePoints.size() + 2, 0);
+
+    // Counting sort of (bucket, point) pairs: count, prefix sum, then scatter.
+    for (const VisiblePoint& point : visiblePoints)
+    {
+        VisitOverlappedCells(point, [this](int bucket) { ++gridStarts[bucket + 1]; });
+    }
+    for (size_t i = 1; i < gridStarts.size(); ++i)
+    {
+        gridStarts[i] += gridStarts[i - 1];
+    }
+
+    gridEntries.resize(gridStarts.back());
+    std::vector<int> fill(gridStarts.begin(), gridStarts.end() - 1);
+    for (size_t i = 0; i < visiblePoints.size(); ++i)
+    {
+        VisitOverlappedCells(visiblePoints[i], [&](int bucket) { gridEntries[fill[bucket]++] = static_cast<int>(i); });
+    }
+}
+
+void ProgressivePhotonMappingRenderer::SplatPhotons(const PhotonBuffer& photons, size_t first, size_t last, std::vector<PhotonSplat>& output) const
+{
+    const size_t diffuseCount = photons.diffuse.size();
+    for (size_t i = first; i < last; ++i)
+    {
+        const Photon& photon = (i < diffuseCount) ? photons.diffuse[i] : photons.caustic[i - diffuseCount];
+        const glm::ivec3 cell(glm::floor(photon.position / gridCellSize));
+        const int bucket = ComputeCellHash(cell);
+        const glm::vec3 photonNormal = photon.GetNormal();
+        const glm::vec3 photonDirection = photon.GetDirection();
+        const glm::vec3 photonPower = photon.GetPower();
+
+        for (int e = gridStarts[bucket]; e < gridStarts[bucket + 1]; ++e)
+        {
+            const VisiblePoint& point = visiblePoints[gridEntries[e]];
+            const glm::vec3 offset = photon.position - point.position;
+            if (glm::dot(offset, offset) > point.radiusSquared)
+                continue;
+            if (std::abs(std::abs(glm::dot(photonNormal, point.normal)) - 1.f) > 1000.f * LARGE_EPSILON)
+                continue;
+
+            PhotonSplat splat;
+            splat.visiblePoint = gridEntries[e];
+            splat.flux = point.diffuseResponse * photonPower * std::max(glm::dot(point.normal, photonDirection), 0.f);
+            output.push_back(splat);
+        }
+    }
+}
+
+void ProgressivePhotonMappingRenderer::RefineImage(ImageWriter& image)
+{
+    MergeThreadVisiblePoints();
+    if (visiblePoints.empty() || photonsPerPass <= 0 || maxPasses <= 0)
+    {
+        return;
+    }
+
+    const int numThreads = GetPhotonThreadCount();
+    PhotonBuffer photons;
+    std::vector<std::vector<PhotonSplat>> splats(numThreads);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    int completedPasses = 0;
+    while (completedPasses < maxPasses)
+    {
+        PROFILE_ZONE("Progressive Pass");
+        BuildVisiblePointGrid();
+        photons.diffuse.clear();
+        photons.caustic.clear();
+        ShootPhotons(photonsPerPass, photonPowerScale, false, false, completedPasses, numThreads, photons);
+
+        // Thread t splats the t-th slice of the diffuse then caustic photons, so concatenating the threads' splats gives
+        // the same order, and the same sums below, for any thread count.
+        const size_t totalPhotons = photons.diffuse.size() + photons.caustic.size();
+        auto splatBuffer = [&](int threadIndex) {
+            splats[threadIndex].clear();
+            SplatPhotons(photons, totalPhotons * threadIndex / numThreads, totalPhotons * (threadIndex + 1) / numThreads, splats[threadIndex]);
+        };
+        std::vector<std::thread> workers;
+        for (int i = 1; i < numThreads; ++i)
+        {
+            workers.push_back(std::thread(splatBuffer, i));
+        }
+        splatBuffer(0);
+        for (auto& t : workers)
+        {
+            t.join();
+        }
+
+        // Gather this pass's photons per point, then shrink the radius keeping radiusReduction of the new photons.
+        std::vector<float> passCounts(visiblePoints.size(), 0.f);
+        std::vector<glm::vec3> passFlux(visiblePoints.size());
+        for (const std::vector<PhotonSplat>& threadSplats : splats)
+        {
+            for (const PhotonSplat& splat : threadSplats)
+            {
+                passCounts[splat.visiblePoint] += 1.f;
+                passFlux[splat.visiblePoint] += splat.flux;
+            }
+        }
+
+        for (size_t i = 0; i < visiblePoints.size(); ++i)
+        {
+            if (passCounts[i] <= 0.f)
+                continue;
+
+            VisiblePoint& point = visiblePoints[i];
+            const float newCount = point.photonCount + radiusReduction * passCounts[i];
+            const float ratio = newCount / (point.photonCount + passCounts[i]);
+            point.radiusSquared *= ratio;
+            point.flux = (point.flux + passFlux[i]) * ratio;
+            point.photonCount = newCount;
+        }
+
+        ++completedPasses;
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (timeBudget > 0.f && elapsed >= timeBudget)
+        {
+            break;
+        }
+    }
+
+    // Photon power is already divided by the photons per pass, so average over the passes.
+    for (const VisiblePoint& point : visiblePoints)
+    {
+        const glm::vec3 indirect = point.flux / (PI * point.radiusSquared * static_cast<float>(completedPasses));
+        image.SetPixelColor(image.GetHDRPixelColor(point.pixel.x, point.pixel.y) + indirect, point.pixel.x, point.pixel.y);
+    }
+}
+
+void ProgressivePhotonMappingRenderer::SetPhotonsPerPass(int photons)
+{
+    photonsPerPass = std::max(photons, 0);
+}
+
+void ProgressivePhotonMappingRenderer::SetMaxPasses(int passes)
+{
+    maxPasses = std::max(passes, 0);
+}
+
+void ProgressivePhotonMappingRenderer::SetTimeBudget(float seconds)
+{
+    timeBudget = std::max(seconds, 0.f);
+}
+
+void ProgressivePhotonMappingRenderer::SetInitialRadius(float radius)
+{
+    initialRadius = radius;
+}
+
+void ProgressivePhotonMappingRenderer::SetRadiusReduction(float alpha)
+{
+    radiusReduction = glm::clamp(alpha, 0.f, 1.f);
+}
+
+void ProgressivePhotonMappingRenderer::SetPhotonPowerScale(float scale)
+{
+    photonPowerScale = scale;
+}
\ No newline at end of file
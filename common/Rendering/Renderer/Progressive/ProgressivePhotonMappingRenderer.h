@@ -0,0 +1,93 @@
+#pragma once
+
+#include "common/Rendering/Renderer/Photon/PhotonMappingRenderer.h"
+#include <mutex>
+
+// Progressive photon mapping (Hachisuka et al.). The camera pass shades direct lighting as usual and stores a visible
+// point wherever a camera sample lands on a diffuse surface, directly or through mirrors and glass. RefineImage then shoots photons in passes, splats each
+// pass onto the visible points and shrinks their radii. Photons are thrown away after every pass, so memory stays
+// constant however many photons are traced, and refinement can stop on a pass count or a wall-clock budget.
+class ProgressivePhotonMappingRenderer : public PhotonMappingRenderer
+{
+public:
+    ProgressivePhotonMappingRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler);
+    virtual void InitializeRenderer() override;
+    glm::vec3 ComputeSampleColor(const struct IntersectionState& intersection, const class Ray& fromCameraRay) const override;
+
+    virtual void BeginPixel(const glm::ivec2& pixel) const override;
+    virtual void EndPixel(const glm::ivec2& pixel, int samplesTaken) const override;
+    virtual void RefineImage(class ImageWriter& image) override;
+
+    void SetPhotonsPerPass(int photons);
+    void SetMaxPasses(int passes);
+    // Stops refining once this many seconds have passed. 0 only uses the pass limit.
+    void SetTimeBudget(float seconds);
+    void SetInitialRadius(float radius);
+    // Fraction of each pass's photons kept when shrinking the radius (alpha in the paper).
+    void SetRadiusReduction(float alpha);
+    void SetPhotonPowerScale(float scale);
+
+private:
+    struct VisiblePoint
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        // Diffuse response to unit light arriving along the normal, scaled by the reflections and refractions that led
+        // the camera sample here. Divided by the samples the pixel took once the points are merged, since only then is
+        // that count known for every pixel.
+        glm::vec3 diffuseResponse;
+        glm::ivec2 pixel;
+
+        float radiusSquared;
+        float photonCount;
+        glm::vec3 flux;
+    };
+
+    // Everything one render thread records: its visible points and the sample count of every pixel it finished.
+    struct ThreadVisiblePoints
+    {
+        std::vector<VisiblePoint> points;
+        std::vector<std::pair<glm::ivec2, int>> pixelSamples;
+    };
+
+    struct PhotonSplat
+    {
+        int visiblePoint;
+        glm::vec3 flux;
+    };
+
+    // The calling thread's visible points for the current render, registered on first use.
+    ThreadVisiblePoints& GetThreadVisiblePoints() const;
+    void MergeThreadVisiblePoints();
+    void BuildVisiblePointGrid();
+    int ComputeCellHash(const glm::ivec3& cell) const;
+    // Calls visit with the bucket of every grid cell the point's radius overlaps.
+    template<typename Visitor>
+    void VisitOverlappedCells(const VisiblePoint& point, Visitor visit) const;
+    // Splats photons [first, last) of the diffuse list followed by the caustic list.
+    void SplatPhotons(const PhotonBuffer& photons, size_t first, size_t last, std::vector<PhotonSplat>& output) const;
+
+    int photonsPerPass;
+    int maxPasses;
+    float timeBudget;
+    float initialRadius;
+    float radiusReduction;
+    float photonPowerScale;
+
+    // Each render thread appends to its own vector, so shading never waits on another thread. The mutex only guards
+    // the list of vectors and is taken once per thread and render. RefineImage merges them into visiblePoints.
+    mutable std::mutex threadPointsMutex;
+    mutable std::vector<std::unique_ptr<ThreadVisiblePoints>> threadVisiblePoints;
+    std::vector<VisiblePoint> visiblePoints;
+
+    // Changes whenever threadVisiblePoints is cleared, so threads know their cached vector is gone.
+    uint64_t renderIndex;
+    static thread_local uint64_t threadRenderIndex;
+    static thread_local ThreadVisiblePoints* threadPoints;
+
+    // Hash grid over the visible points, rebuilt every pass as the radii shrink. Entries for cell bucket b live in
+    // gridEntries[gridStarts[b], gridStarts[b + 1]).
+    float gridCellSize;
+    std::vector<int> gridStarts;
+    std::vector<int> gridEntries;
+};
\ No newline at end of file
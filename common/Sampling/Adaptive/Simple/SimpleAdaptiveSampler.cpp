@@ -5,16 +5,25 @@ SimpleAdaptiveSampler::SimpleAdaptiveSampler() :
 {
 }
 
-std::unique_ptr<SamplerState> SimpleAdaptiveSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+std::unique_ptr<SamplerState> SimpleAdaptiveSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
 {
-    std::unique_ptr<SimpleAdaptiveSamplerState> state = make_unique<SimpleAdaptiveSamplerState>(randomDevice, maxSamples, dimensions);
-    state->internalState = internalSampler->CreateSampler(randomDevice, maxSamples, dimensions);
+    std::unique_ptr<SimpleAdaptiveSamplerState> state = make_unique<SimpleAdaptiveSamplerState>(generator, maxSamples, dimensions);
+    state->internalState = internalSampler->CreateSampler(generator, maxSamples, dimensions);
     return std::move(state);
 }
 
+void SimpleAdaptiveSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
+{
+    ColorSampler::ResetSampler(state, generator);
+    internalSampler->ResetSampler(*static_cast<SimpleAdaptiveSamplerState&>(state).internalState.get(), generator);
+}
+
 glm::vec3 SimpleAdaptiveSampler::ComputeSampleCoordinate(SamplerState& state) const
 {
-    return internalSampler->ComputeSampleCoordinate(state);
+    // The internal sampler may keep its own state (scramble seeds, tile offsets), so hand it the state it created.
+    SimpleAdaptiveSamplerState& adaptiveState = static_cast<SimpleAdaptiveSamplerState&>(state);
+    adaptiveState.internalState->samplesComputed = state.samplesComputed;
+    return internalSampler->ComputeSampleCoordinate(*adaptiveState.internalState.get());
 }
 
 void SimpleAdaptiveSampler::InitializeSampler(class Application* app, class Scene* inputScene)
@@ -48,6 +57,11 @@ bool SimpleAdaptiveSampler::NotifyColorSampleForEarlyExit(SamplerState& state, g
     return false;
 }
 
+bool SimpleAdaptiveSampler::KeepsColorHistory() const
+{
+    return true;
+}
+
 void SimpleAdaptiveSampler::SetEarlyExitParameters(float threshold, int minSampleCount)
 {
     earlyExitThreshold = threshold;
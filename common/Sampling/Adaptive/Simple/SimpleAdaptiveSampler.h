@@ -4,8 +4,8 @@
 
 struct SimpleAdaptiveSamplerState : public SamplerState
 {
-    SimpleAdaptiveSamplerState(std::random_device& device, int inputMax, int inputDim) :
-        SamplerState(device, inputMax, inputDim)
+    SimpleAdaptiveSamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+        SamplerState(generator, inputMax, inputDim)
     {
     }
 
@@ -19,13 +19,15 @@ public:
     void SetInternalSampler(std::shared_ptr<ColorSampler> inputSampler);
     void SetEarlyExitParameters(float threshold, int minSampleCount);
 
-    virtual std::unique_ptr<SamplerState> CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const override;
+    virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const override;
     virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
 
     virtual void InitializeSampler(class Application* app, class Scene* inputScene) override;
 
 protected:
     virtual bool NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const override;
+    virtual bool KeepsColorHistory() const override;
 private:
     std::shared_ptr<ColorSampler> internalSampler;
     float earlyExitThreshold;
@@ -0,0 +1,92 @@
+#include "common/Sampling/Adaptive/Variance/VarianceAdaptiveSampler.h"
+
+namespace
+{
+// Keeps nearly black pixels from demanding an interval of zero width.
+const float MIN_REFERENCE_LUMINANCE = 1e-2f;
+
+float Luminance(const glm::vec3& color)
+{
+    return 0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b;
+}
+}
+
+VarianceAdaptiveSampler::VarianceAdaptiveSampler() :
+    relativeErrorThreshold(0.05f), minimumSamples(8), confidenceScale(1.96f)
+{
+    internalSampler = std::make_shared<ColorSampler>();
+}
+
+void VarianceAdaptiveSampler::SetInternalSampler(std::shared_ptr<ColorSampler> inputSampler)
+{
+    assert(inputSampler);
+    internalSampler = std::move(inputSampler);
+}
+
+void VarianceAdaptiveSampler::SetErrorParameters(float relativeError, int minSampleCount, float inputConfidenceScale)
+{
+    assert(relativeError >= 0.f && inputConfidenceScale > 0.f);
+    relativeErrorThreshold = relativeError;
+    // The variance estimate needs at least two samples.
+    minimumSamples = std::max(minSampleCount, 2);
+    confidenceScale = inputConfidenceScale;
+}
+
+std::unique_ptr<SamplerState> VarianceAdaptiveSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
+{
+    std::unique_ptr<VarianceAdaptiveSamplerState> state = make_unique<VarianceAdaptiveSamplerState>(generator, maxSamples, dimensions);
+    state->internalState = internalSampler->CreateSampler(generator, maxSamples, dimensions);
+    return std::move(state);
+}
+
+void VarianceAdaptiveSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
+{
+    ColorSampler::ResetSampler(state, generator);
+    VarianceAdaptiveSamplerState& varianceState = static_cast<VarianceAdaptiveSamplerState&>(state);
+    internalSampler->ResetSampler(*varianceState.internalState.get(), generator);
+    varianceState.luminanceMean = 0.f;
+    varianceState.luminanceM2 = 0.f;
+}
+
+glm::vec3 VarianceAdaptiveSampler::ComputeSampleCoordinate(SamplerState& state) const
+{
+    VarianceAdaptiveSamplerState& varianceState = static_cast<VarianceAdaptiveSamplerState&>(state);
+    varianceState.internalState->samplesComputed = state.samplesComputed;
+    return internalSampler->ComputeSampleCoordinate(*varianceState.internalState.get());
+}
+
+void VarianceAdaptiveSampler::InitializeSampler(class Application* app, class Scene* inputScene)
+{
+    ColorSampler::InitializeSampler(app, inputScene);
+    internalSampler->InitializeSampler(app, inputScene);
+}
+
+bool VarianceAdaptiveSampler::NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const
+{
+    // samplesComputed already includes this sample.
+    VarianceAdaptiveSamplerState& varianceState = static_cast<VarianceAdaptiveSamplerState&>(state);
+    const float luminance = Luminance(inColor);
+    const float delta = luminance - varianceState.luminanceMean;
+    varianceState.luminanceMean += delta / static_cast<float>(state.samplesComputed);
+    varianceState.luminanceM2 += delta * (luminance - varianceState.luminanceMean);
+
+    if (state.samplesComputed < minimumSamples)
+    {
+        return false;
+    }
+    return EstimateRelativeError(state) <= relativeErrorThreshold;
+}
+
+float VarianceAdaptiveSampler::EstimateRelativeError(const SamplerState& state) const
+{
+    const VarianceAdaptiveSamplerState& varianceState = static_cast<const VarianceAdaptiveSamplerState&>(state);
+    const int n = state.samplesComputed;
+    if (n < 2)
+    {
+        return 0.f;
+    }
+
+    const float variance = varianceState.luminanceM2 / static_cast<float>(n - 1);
+    const float standardError = std::sqrt(std::max(variance, 0.f) / static_cast<float>(n));
+    return confidenceScale * standardError / std::max(varianceState.luminanceMean, MIN_REFERENCE_LUMINANCE);
+}
\ No newline at end of file
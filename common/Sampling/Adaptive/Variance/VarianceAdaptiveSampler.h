@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common/Sampling/ColorSampler.h"
+
+struct VarianceAdaptiveSamplerState : public SamplerState
+{
+    VarianceAdaptiveSamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+        SamplerState(generator, inputMax, inputDim), luminanceMean(0.f), luminanceM2(0.f)
+    {
+    }
+
+    std::unique_ptr<SamplerState> internalState;
+
+    // Welford's running mean and sum of squared deviations of the sample luminance.
+    float luminanceMean;
+    float luminanceM2;
+};
+
+// Keeps sampling a pixel until the confidence interval of its mean luminance is small relative to the luminance itself.
+// Only running statistics are kept, so the cost per sample does not grow with the sample count.
+class VarianceAdaptiveSampler : public ColorSampler
+{
+public:
+    VarianceAdaptiveSampler();
+    void SetInternalSampler(std::shared_ptr<ColorSampler> inputSampler);
+
+    // Stops once confidenceScale * standard error <= relativeError * luminance, but never before minSampleCount samples.
+    // The default confidence scale corresponds to a 95% interval.
+    void SetErrorParameters(float relativeError, int minSampleCount, float confidenceScale = 1.96f);
+
+    virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const override;
+    virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
+
+    virtual void InitializeSampler(class Application* app, class Scene* inputScene) override;
+
+protected:
+    virtual bool NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const override;
+    virtual float EstimateRelativeError(const SamplerState& state) const override;
+private:
+    std::shared_ptr<ColorSampler> internalSampler;
+    float relativeErrorThreshold;
+    int minimumSamples;
+    float confidenceScale;
+};
\ No newline at end of file
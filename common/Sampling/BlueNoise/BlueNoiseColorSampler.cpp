@@ -0,0 +1,75 @@
+#include "common/Sampling/BlueNoise/BlueNoiseColorSampler.h"
+
+namespace
+{
+// Mitchell's best-candidate algorithm tries this many candidates per point already placed.
+const int CANDIDATES_PER_POINT = 4;
+}
+
+BlueNoiseColorSampler::BlueNoiseColorSampler() :
+    tileCount(16), samplesPerTile(64)
+{
+    GenerateTiles();
+}
+
+void BlueNoiseColorSampler::SetTileParameters(int inputTileCount, int inputSamplesPerTile)
+{
+    assert(inputTileCount > 0 && inputSamplesPerTile > 0);
+    tileCount = inputTileCount;
+    samplesPerTile = inputSamplesPerTile;
+    GenerateTiles();
+}
+
+void BlueNoiseColorSampler::GenerateTiles()
+{
+    std::vector<std::vector<glm::vec2>> tilePoints(tileCount);
+    for (int tile = 0; tile < tileCount; ++tile)
+    {
+        RandomGenerator generator(0, static_cast<uint64_t>(tile));
+        std::vector<glm::vec2>& points = tilePoints[tile];
+        points.reserve(samplesPerTile);
+        points.push_back(glm::vec2(generator.NextFloat(), generator.NextFloat()));
+
+        for (int placed = 1; placed < samplesPerTile; ++placed)
+        {
+            glm::vec2 bestCandidate;
+            float bestDistance = -1.f;
+            for (int c = 0; c < placed * CANDIDATES_PER_POINT; ++c)
+            {
+                const glm::vec2 candidate(generator.NextFloat(), generator.NextFloat());
+                float closestDistance = std::numeric_limits<float>::max();
+                for (const glm::vec2& point : points)
+                {
+                    closestDistance = std::min(closestDistance, SampleTiles::ToroidalDistanceSquared(candidate, point));
+                }
+
+                if (closestDistance > bestDistance)
+                {
+                    bestDistance = closestDistance;
+                    bestCandidate = candidate;
+                }
+            }
+            points.push_back(bestCandidate);
+        }
+    }
+    tiles.Assign(tilePoints);
+}
+
+std::unique_ptr<SamplerState> BlueNoiseColorSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
+{
+    std::unique_ptr<BlueNoiseSamplerState> state = make_unique<BlueNoiseSamplerState>(generator, maxSamples, dimensions);
+    ResetSampler(*state.get(), generator);
+    return std::move(state);
+}
+
+void BlueNoiseColorSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
+{
+    ColorSampler::ResetSampler(state, generator);
+    tiles.ResetCursor(static_cast<BlueNoiseSamplerState&>(state).tileCursor, generator);
+}
+
+glm::vec3 BlueNoiseColorSampler::ComputeSampleCoordinate(SamplerState& state) const
+{
+    const glm::vec2 point = tiles.GetPoint(static_cast<const BlueNoiseSamplerState&>(state).tileCursor, state.samplesComputed);
+    return glm::vec3(point.x, point.y, GenerateRandomNumber(state));
+}
\ No newline at end of file
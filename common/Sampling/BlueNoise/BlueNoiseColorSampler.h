@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/Tiles/SampleTiles.h"
+
+struct BlueNoiseSamplerState : public SamplerState
+{
+    BlueNoiseSamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+        SamplerState(generator, inputMax, inputDim)
+    {
+    }
+
+    SampleTileCursor tileCursor;
+};
+
+// Draws the first two dimensions from a set of precomputed blue-noise tiles, picked and toroidally shifted at random
+// for every sampler state. The third dimension is uniform random.
+class BlueNoiseColorSampler : public ColorSampler
+{
+public:
+    BlueNoiseColorSampler();
+
+    // Regenerates the tile set. Every prefix of a tile is well spread, so states asking for fewer samples still get
+    // blue-noise points. Requests beyond samplesPerTile continue into the next tile.
+    void SetTileParameters(int tileCount, int samplesPerTile);
+
+    virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const override;
+    virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
+private:
+    void GenerateTiles();
+
+    int tileCount;
+    int samplesPerTile;
+    SampleTiles tiles;
+};
\ No newline at end of file
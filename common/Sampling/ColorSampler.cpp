@@ -1,7 +1,27 @@
 #include "common/Sampling/ColorSampler.h"
+#include <atomic>
+
+namespace
+{
+struct SamplerCacheEntry
+{
+    uint64_t samplerId;
+    const RandomGenerator* generator;
+    int maxSamples;
+    int dimensions;
+    bool inUse;
+    std::unique_ptr<SamplerState> state;
+};
+
+// Pixel, light and gather samplers each keep an entry; the cap only matters if samplers keep getting recreated.
+const size_t MAX_CACHED_SAMPLER_STATES = 16;
+thread_local std::vector<SamplerCacheEntry> samplerCache;
+}
 
 ColorSampler::ColorSampler()
 {
+    static std::atomic<uint64_t> nextSamplerId(0);
+    samplerId = nextSamplerId++;
 }
 
 void ColorSampler::InitializeSampler(Application* app, Scene* inputScene)
@@ -10,36 +30,15 @@ void ColorSampler::InitializeSampler(Application* app, Scene* inputScene)
     storedScene = inputScene;
 }
 
-std::unique_ptr<SamplerState> ColorSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+std::unique_ptr<SamplerState> ColorSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
 {
-    return std::move(make_unique<SamplerState>(randomDevice, maxSamples, dimensions));
+    return std::move(make_unique<SamplerState>(generator, maxSamples, dimensions));
 }
 
-glm::vec3 ColorSampler::ComputeSamplesAndColor(const int maxSamples, const int dimensions, std::function<glm::vec3(glm::vec3)> colorComputer) const
+void ColorSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
 {
-    std::random_device randomDevice;
-    std::unique_ptr<SamplerState> newState = CreateSampler(randomDevice, maxSamples, dimensions);
-
-    glm::vec3 finalColor;
-    for (int i = 0; i < maxSamples; ++i) {
-        // Compute normalized sample. 
-        glm::vec3 sampleCoordinates = ComputeSampleCoordinate(*newState.get());
-
-        // Compute sample color.
-        glm::vec3 sampleColor = colorComputer(sampleCoordinates);
-        finalColor += sampleColor;
-        ++newState->samplesComputed;
-
-        if (NotifyColorSampleForEarlyExit(*newState.get(), sampleColor)) 
-		{
-            break;
-        }
-
-        newState->colorHistory.push_back(sampleColor);
-        
-    }
-    finalColor /= static_cast<float>(newState->samplesComputed);
-    return finalColor;
+    state.samplesComputed = 0;
+    state.colorHistory.clear();
 }
 
 glm::vec3 ColorSampler::ComputeSampleCoordinate(SamplerState& state) const
@@ -54,10 +53,74 @@ glm::vec3 ColorSampler::ComputeSampleCoordinate(SamplerState& state) const
 
 float ColorSampler::GenerateRandomNumber(SamplerState& state) const
 {
-    return static_cast<float>(state.dist(state.gen));
+    return state.gen.NextFloat();
 }
 
 bool ColorSampler::NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const
 {
     return false;
 }
+
+float ColorSampler::EstimateRelativeError(const SamplerState& state) const
+{
+    return 0.f;
+}
+
+bool ColorSampler::KeepsColorHistory() const
+{
+    return false;
+}
+
+ScopedSamplerState::ScopedSamplerState(const ColorSampler& sampler, RandomGenerator& generator, int maxSamples, int dimensions) :
+    cacheIndex(-1), state(nullptr)
+{
+    int freeIndex = -1;
+    for (size_t i = 0; i < samplerCache.size(); ++i)
+    {
+        SamplerCacheEntry& entry = samplerCache[i];
+        if (entry.inUse)
+        {
+            continue;
+        }
+
+        if (entry.samplerId == sampler.samplerId && entry.generator == &generator && entry.maxSamples == maxSamples && entry.dimensions == dimensions)
+        {
+            entry.inUse = true;
+            sampler.ResetSampler(*entry.state.get(), generator);
+            cacheIndex = static_cast<int>(i);
+            state = entry.state.get();
+            return;
+        }
+        freeIndex = static_cast<int>(i);
+    }
+
+    std::unique_ptr<SamplerState> newState = sampler.CreateSampler(generator, maxSamples, dimensions);
+    state = newState.get();
+    if (samplerCache.size() < MAX_CACHED_SAMPLER_STATES)
+    {
+        freeIndex = static_cast<int>(samplerCache.size());
+        samplerCache.push_back(SamplerCacheEntry());
+    }
+    else if (freeIndex < 0)
+    {
+        ownedState = std::move(newState);
+        return;
+    }
+
+    SamplerCacheEntry& entry = samplerCache[freeIndex];
+    entry.samplerId = sampler.samplerId;
+    entry.generator = &generator;
+    entry.maxSamples = maxSamples;
+    entry.dimensions = dimensions;
+    entry.inUse = true;
+    entry.state = std::move(newState);
+    cacheIndex = freeIndex;
+}
+
+ScopedSamplerState::~ScopedSamplerState()
+{
+    if (cacheIndex >= 0)
+    {
+        samplerCache[cacheIndex].inUse = false;
+    }
+}
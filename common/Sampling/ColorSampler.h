@@ -1,24 +1,38 @@
 #pragma once
 
 #include "common/common.h"
+#include "common/Sampling/Random/RandomGenerator.h"
 
 
 struct SamplerState
 {
-    SamplerState(std::random_device& device, int inputMax, int inputDim) :
-        maxSamples(inputMax), dimensions(inputDim), samplesComputed(0), gen(device()), dist(0, 1)
+    SamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+        maxSamples(inputMax), dimensions(inputDim), samplesComputed(0), gen(generator)
     {
     }
+    virtual ~SamplerState() {}
 
     std::vector<glm::vec3> colorHistory;
-	std::vector<glm::vec3> positionHistory;
 
     const int maxSamples;
     const int dimensions;
     int samplesComputed;
 
-    std::mt19937 gen;
-    std::uniform_real_distribution<> dist;
+    RandomGenerator& gen;
+};
+
+// What a ComputeSamplesAndColor call spent on one pixel. Feeds the adaptive second pass and the sample-count image.
+struct PixelSampleStatistics
+{
+    PixelSampleStatistics() : samplesTaken(0), relativeError(0.f), converged(false)
+    {
+    }
+
+    int samplesTaken;
+    // Confidence interval of the pixel estimate relative to its luminance, 0 if the sampler does not track it.
+    float relativeError;
+    // Whether the sampler stopped because the pixel met its own convergence test, including on the last allowed sample.
+    bool converged;
 };
 
 class ColorSampler : public std::enable_shared_from_this<ColorSampler>
@@ -26,15 +40,91 @@ class ColorSampler : public std::enable_shared_from_this<ColorSampler>
 public:
     ColorSampler();
 
-    virtual std::unique_ptr<SamplerState> CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const;
+    virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const;
+    // Prepares a state made by CreateSampler for a new pixel: clears the counters and redraws any per-state randomness.
+    virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const;
     virtual void InitializeSampler(class Application* app, class Scene* inputScene);
 
-    virtual glm::vec3 ComputeSamplesAndColor(const int maxSamples, const int dimensions, std::function<glm::vec3(glm::vec3)> colorComputer) const;
+    // colorComputer is any callable taking the sample coordinate and returning its color. Taking it as a template
+    // parameter lets the per-sample call inline instead of going through std::function.
+    template <typename ColorComputer>
+    glm::vec3 ComputeSamplesAndColor(const int maxSamples, const int dimensions, const ColorComputer& colorComputer,
+                                     PixelSampleStatistics* statistics = nullptr) const;
     virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const;
 protected:
     virtual float GenerateRandomNumber(SamplerState& state) const;
     virtual bool NotifyColorSampleForEarlyExit(SamplerState& state, glm::vec3 inColor) const;
+    virtual float EstimateRelativeError(const SamplerState& state) const;
+    // Only samplers that look at earlier colors need SamplerState::colorHistory filled in.
+    virtual bool KeepsColorHistory() const;
 
     class Application* storedApp;
     class Scene* storedScene;
-};
\ No newline at end of file
+private:
+    friend class ScopedSamplerState;
+    // Unique for the lifetime of the program, so cached states never outlive their sampler under a reused address.
+    uint64_t samplerId;
+};
+
+// A sampler state that is cached per thread and sampler and only reset between uses, so shading a pixel does not
+// allocate. A second state for the same sampler further up the call stack gets a fresh, uncached state.
+class ScopedSamplerState
+{
+public:
+    ScopedSamplerState(const ColorSampler& sampler, RandomGenerator& generator, int maxSamples, int dimensions);
+    ~ScopedSamplerState();
+
+    SamplerState& Get()
+    {
+        return *state;
+    }
+
+private:
+    ScopedSamplerState(const ScopedSamplerState&) = delete;
+    ScopedSamplerState& operator=(const ScopedSamplerState&) = delete;
+
+    int cacheIndex;
+    std::unique_ptr<SamplerState> ownedState;
+    SamplerState* state;
+};
+
+template <typename ColorComputer>
+glm::vec3 ColorSampler::ComputeSamplesAndColor(const int maxSamples, const int dimensions, const ColorComputer& colorComputer,
+                                               PixelSampleStatistics* statistics) const
+{
+    ScopedSamplerState scopedState(*this, RandomGenerator::GetThreadGenerator(), maxSamples, dimensions);
+    SamplerState& state = scopedState.Get();
+    const bool keepColorHistory = KeepsColorHistory();
+
+    glm::vec3 finalColor;
+    bool converged = false;
+    for (int i = 0; i < maxSamples; ++i) {
+        // Compute normalized sample. 
+        const glm::vec3 sampleCoordinates = ComputeSampleCoordinate(state);
+
+        // Compute sample color.
+        const glm::vec3 sampleColor = colorComputer(sampleCoordinates);
+        finalColor += sampleColor;
+        ++state.samplesComputed;
+
+        if (NotifyColorSampleForEarlyExit(state, sampleColor)) 
+        {
+            converged = true;
+            break;
+        }
+
+        if (keepColorHistory)
+        {
+            state.colorHistory.push_back(sampleColor);
+        }
+    }
+    finalColor /= static_cast<float>(state.samplesComputed);
+
+    if (statistics)
+    {
+        statistics->samplesTaken = state.samplesComputed;
+        statistics->relativeError = EstimateRelativeError(state);
+        statistics->converged = converged;
+    }
+    return finalColor;
+}
\ No newline at end of file
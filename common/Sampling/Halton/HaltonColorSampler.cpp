@@ -0,0 +1,53 @@
+#include "common/Sampling/Halton/HaltonColorSampler.h"
+
+namespace
+{
+// Largest float below 1.
+const float ONE_MINUS_EPSILON = 0.99999994f;
+
+float RadicalInverse(uint32_t index, uint32_t base)
+{
+    const double inverseBase = 1.0 / static_cast<double>(base);
+    double inverseBaseN = 1.0;
+    uint64_t reversedDigits = 0;
+    while (index != 0)
+    {
+        const uint32_t next = index / base;
+        reversedDigits = reversedDigits * base + (index - next * base);
+        inverseBaseN *= inverseBase;
+        index = next;
+    }
+    return std::min(static_cast<float>(reversedDigits * inverseBaseN), ONE_MINUS_EPSILON);
+}
+}
+
+std::unique_ptr<SamplerState> HaltonColorSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
+{
+    std::unique_ptr<HaltonSamplerState> state = make_unique<HaltonSamplerState>(generator, maxSamples, dimensions);
+    ResetSampler(*state.get(), generator);
+    return std::move(state);
+}
+
+void HaltonColorSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
+{
+    ColorSampler::ResetSampler(state, generator);
+    HaltonSamplerState& haltonState = static_cast<HaltonSamplerState&>(state);
+    // Keep the offset small enough that the radical inverses stay exact in single precision.
+    haltonState.indexOffset = generator.Next() >> 12;
+    haltonState.shift = glm::vec3(generator.NextFloat(), generator.NextFloat(), generator.NextFloat());
+}
+
+glm::vec3 HaltonColorSampler::ComputeSampleCoordinate(SamplerState& state) const
+{
+    const HaltonSamplerState& haltonState = static_cast<const HaltonSamplerState&>(state);
+    const uint32_t index = haltonState.indexOffset + static_cast<uint32_t>(state.samplesComputed);
+
+    const uint32_t bases[3] = { 2, 3, 5 };
+    glm::vec3 sample;
+    for (int i = 0; i < 3; ++i)
+    {
+        const float shifted = RadicalInverse(index, bases[i]) + haltonState.shift[i];
+        sample[i] = std::min(shifted - std::floor(shifted), ONE_MINUS_EPSILON);
+    }
+    return sample;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/Sampling/ColorSampler.h"
+
+struct HaltonSamplerState : public SamplerState
+{
+    HaltonSamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+        SamplerState(generator, inputMax, inputDim), indexOffset(0)
+    {
+    }
+
+    uint32_t indexOffset;
+    glm::vec3 shift;
+};
+
+// Halton points in bases 2, 3 and 5. Each sampler state starts at a random index and applies a random toroidal shift
+// so neighbouring pixels do not repeat the same pattern.
+class HaltonColorSampler : public ColorSampler
+{
+public:
+    virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const override;
+    virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
+};
\ No newline at end of file
@@ -1,47 +1,164 @@
 #include "common/Sampling/PoissonDisks/PoissonDisksColorSampler.h"
 
+namespace
+{
+const int POISSON_TILE_COUNT = 8;
+// Bridson's k: candidates tried around an active sample before it is retired.
+const int POISSON_CANDIDATES = 30;
 
-void PoissonDisksColorSampler::SetRadius(float inputRadius)
+// Index of the cell holding point in a 2^levels grid, as a Morton code with its bit pairs reversed: the quadrant is in
+// the lowest two bits, the sub-quadrant in the next two, and so on. Sorting by it visits one cell per quadrant, then one
+// per sub-quadrant, like a base-4 radical inverse, so any prefix of a tile is spread over the whole square. The grid has
+// to be about as fine as the samples are dense; finer bits would only sort by noise.
+uint32_t ProgressiveKey(const glm::vec2& point, int levels)
 {
-	assert(inputRadius >= 0.f);
-	radius = inputRadius;
+	const uint32_t cells = 1u << levels;
+	const uint32_t x = std::min(static_cast<uint32_t>(point.x * cells), cells - 1);
+	const uint32_t y = std::min(static_cast<uint32_t>(point.y * cells), cells - 1);
+	uint32_t key = 0;
+	for (int level = 0; level < levels; ++level)
+	{
+		const int bit = levels - 1 - level;
+		key |= ((x >> bit) & 1u) << (2 * level + 1);
+		key |= ((y >> bit) & 1u) << (2 * level);
+	}
+	return key;
 }
 
-glm::vec3 PoissonDisksColorSampler::ComputeSampleCoordinate(SamplerState& state) const
+void GeneratePoissonTile(float minDistance, RandomGenerator& generator, std::vector<glm::vec2>& output)
 {
-	bool goodPlacement = false;
+	// Cells small enough to hold at most one sample; the grid wraps around like the tile itself.
+	const int gridSize = std::max(static_cast<int>(std::ceil(std::sqrt(2.f) / minDistance)), 1);
+	const int searchRange = static_cast<int>(std::ceil(minDistance * gridSize));
+	const float minDistanceSquared = minDistance * minDistance;
+	std::vector<int> grid(static_cast<size_t>(gridSize) * gridSize, -1);
+
+	std::vector<glm::vec2> points;
+	std::vector<int> active;
+	auto cellOf = [gridSize](const glm::vec2& p) {
+		return glm::ivec2(std::min(static_cast<int>(p.x * gridSize), gridSize - 1), std::min(static_cast<int>(p.y * gridSize), gridSize - 1));
+	};
+	auto addPoint = [&](const glm::vec2& p) {
+		const glm::ivec2 cell = cellOf(p);
+		grid[cell.y * gridSize + cell.x] = static_cast<int>(points.size());
+		active.push_back(static_cast<int>(points.size()));
+		points.push_back(p);
+	};
 
-	glm::vec3 random = ColorSampler::ComputeSampleCoordinate(state);
-	glm::vec3 newSample = (1.f - 2.f*radius) * random;
-	while (!goodPlacement)
+	addPoint(glm::vec2(generator.NextFloat(), generator.NextFloat()));
+	while (!active.empty())
 	{
-		bool exited = false;
-		for (auto pos: state.positionHistory)
+		const size_t activeIndex = generator.Next() % active.size();
+		const glm::vec2 center = points[active[activeIndex]];
+
+		bool placed = false;
+		for (int k = 0; k < POISSON_CANDIDATES && !placed; ++k)
 		{
-			float dist = sqrt((pos - newSample - radius).x * (pos - newSample - radius).x + (pos - newSample).y * (pos - newSample).y);
-			if (dist < 2.f * radius)
+			// Uniform over the annulus between one and two minimum distances.
+			const float distance = minDistance * std::sqrt(1.f + 3.f * generator.NextFloat());
+			const float angle = 2.f * PI * generator.NextFloat();
+			glm::vec2 candidate = center + distance * glm::vec2(std::cos(angle), std::sin(angle));
+			candidate -= glm::floor(candidate);
+			candidate = glm::min(candidate, glm::vec2(0.99999994f));
+
+			const glm::ivec2 cell = cellOf(candidate);
+			bool isFarEnough = true;
+			for (int dy = -searchRange; dy <= searchRange && isFarEnough; ++dy)
 			{
-				random = ColorSampler::ComputeSampleCoordinate(state);
-				newSample = (1.f - 2.f*radius) * random;
+				for (int dx = -searchRange; dx <= searchRange; ++dx)
+				{
+					const int neighbourX = ((cell.x + dx) % gridSize + gridSize) % gridSize;
+					const int neighbourY = ((cell.y + dy) % gridSize + gridSize) % gridSize;
+					const int neighbour = grid[neighbourY * gridSize + neighbourX];
+					if (neighbour >= 0 && SampleTiles::ToroidalDistanceSquared(candidate, points[neighbour]) < minDistanceSquared)
+					{
+						isFarEnough = false;
+						break;
+					}
+				}
+			}
 
-				exited = true;
-				break;
+			if (isFarEnough)
+			{
+				addPoint(candidate);
+				placed = true;
 			}
 		}
-		goodPlacement = !exited;
+
+		if (!placed)
+		{
+			active[activeIndex] = active.back();
+			active.pop_back();
+		}
 	}
-	
-	state.positionHistory.push_back(newSample + glm::vec3(radius));
 
-	return newSample;
+	// log4 of the sample count, so there is about one sample per cell at the finest level.
+	int levels = 0;
+	while (levels < 15 && (size_t(1) << (2 * levels)) < points.size())
+	{
+		++levels;
+	}
+	std::stable_sort(points.begin(), points.end(), [levels](const glm::vec2& a, const glm::vec2& b) {
+		return ProgressiveKey(a, levels) < ProgressiveKey(b, levels);
+	});
+	output.insert(output.end(), points.begin(), points.end());
+}
 }
 
-std::unique_ptr<SamplerState> PoissonDisksColorSampler::CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const
+PoissonDisksColorSampler::PoissonDisksColorSampler() :
+	radius(0.f)
 {
-	std::unique_ptr< PoissonDisksSamplerState> state = make_unique< PoissonDisksSamplerState>(randomDevice, maxSamples, dimensions);
+}
+
+void PoissonDisksColorSampler::SetRadius(float inputRadius)
+{
+	assert(inputRadius >= 0.f);
+	radius = inputRadius;
+	GenerateTiles();
+}
+
+void PoissonDisksColorSampler::GenerateTiles()
+{
+	tiles.Clear();
+	if (radius <= 0.f)
+	{
+		return;
+	}
+
+	// Bridson's algorithm does not produce a fixed count; SampleTiles cuts every tile down to the smallest one.
+	std::vector<std::vector<glm::vec2>> tilePoints(POISSON_TILE_COUNT);
+	for (int tile = 0; tile < POISSON_TILE_COUNT; ++tile)
+	{
+		RandomGenerator generator(0, static_cast<uint64_t>(tile));
+		GeneratePoissonTile(2.f * radius, generator, tilePoints[tile]);
+	}
+	tiles.Assign(tilePoints);
+}
+
+glm::vec3 PoissonDisksColorSampler::ComputeSampleCoordinate(SamplerState& state) const
+{
+	if (tiles.IsEmpty())
+	{
+		return ColorSampler::ComputeSampleCoordinate(state);
+	}
+
+	const glm::vec2 point = tiles.GetPoint(static_cast<const PoissonDisksSamplerState&>(state).tileCursor, state.samplesComputed);
+	return glm::vec3(point.x, point.y, GenerateRandomNumber(state));
+}
+
+std::unique_ptr<SamplerState> PoissonDisksColorSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
+{
+	std::unique_ptr< PoissonDisksSamplerState> state = make_unique< PoissonDisksSamplerState>(generator, maxSamples, dimensions);
 	state->numSamples = maxSamples;
+	ResetSampler(*state.get(), generator);
 
 	assert(state->numSamples > 0);
 
 	return std::move(state);
+}
+
+void PoissonDisksColorSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
+{
+	ColorSampler::ResetSampler(state, generator);
+	tiles.ResetCursor(static_cast<PoissonDisksSamplerState&>(state).tileCursor, generator);
 }
\ No newline at end of file
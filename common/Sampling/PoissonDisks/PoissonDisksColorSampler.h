@@ -1,25 +1,37 @@
 #pragma once
 
 #include "common/Sampling/ColorSampler.h"
+#include "common/Sampling/Tiles/SampleTiles.h"
 
 
 struct PoissonDisksSamplerState : public SamplerState
 {
-	PoissonDisksSamplerState(std::random_device& device, int inputMax, int inputDim) :
-		SamplerState(device, inputMax, inputDim), numSamples(0)
+	PoissonDisksSamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+		SamplerState(generator, inputMax, inputDim), numSamples(0)
 	{
 	}
 
 	int numSamples;
+	SampleTileCursor tileCursor;
 };
 
+// Poisson-disk samples in the first two dimensions, taken from a small set of periodic tiles that are generated once
+// with Bridson's algorithm. Each sampler state picks a tile and a random toroidal shift, so a sample costs about as
+// much as a jittered one. The third dimension is uniform random.
 class PoissonDisksColorSampler : public ColorSampler
 {
 public:
+	PoissonDisksColorSampler();
+
+	// Disks of this radius never overlap, i.e. samples are at least 2 * radius apart. 0 falls back to uniform random.
 	void SetRadius(float inputRadius);
 
-	virtual std::unique_ptr<SamplerState> CreateSampler(std::random_device& randomDevice, const int maxSamples, const int dimensions) const override;
+	virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const override;
+	virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const override;
 	virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
 private:
+	void GenerateTiles();
+
 	float radius;
+	SampleTiles tiles;
 };
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "common/Sampling/Random/RandomGenerator.h"
+#include <atomic>
+
+RandomGenerator& RandomGenerator::GetThreadGenerator()
+{
+    // Threads that never get reseeded (e.g. preprocessing workers) still need distinct streams.
+    static std::atomic<uint64_t> nextStream(0);
+    thread_local RandomGenerator generator(0, nextStream++);
+    return generator;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common/common.h"
+
+// PCG32 (XSH RR variant). Sixteen bytes of state and a few instructions per number, so every thread can own one and
+// reseed it per pixel. Meets the UniformRandomBitGenerator requirements so it also works with the <random> distributions.
+class RandomGenerator
+{
+public:
+    typedef uint32_t result_type;
+
+    RandomGenerator(uint64_t seed = 0, uint64_t stream = 0)
+    {
+        Seed(seed, stream);
+    }
+
+    // Generators with the same seed but different streams produce independent sequences.
+    void Seed(uint64_t seed, uint64_t stream)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    uint32_t Next()
+    {
+        const uint64_t oldState = state;
+        state = oldState * 6364136223846793005ULL + increment;
+        const uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18) ^ oldState) >> 27);
+        const uint32_t rotation = static_cast<uint32_t>(oldState >> 59);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+    // Uniform in [0, 1).
+    float NextFloat()
+    {
+        return static_cast<float>(Next() >> 8) * (1.f / 16777216.f);
+    }
+
+    // Uniform in [0, 1].
+    float NextFloatClosed()
+    {
+        return static_cast<float>(Next() >> 8) * (1.f / 16777215.f);
+    }
+
+    result_type operator()()
+    {
+        return Next();
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type max()
+    {
+        return 0xFFFFFFFFu;
+    }
+
+    // Generator owned by the calling thread. The ray tracer reseeds it for every pixel so a render does not depend on
+    // which thread picked up which tile.
+    static RandomGenerator& GetThreadGenerator();
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
\ No newline at end of file
@@ -2,4 +2,8 @@
 
 #include "common/Sampling/ColorSampler.h"
 #include "common/Sampling/Jitter/JitterColorSampler.h"
-#include "common/Sampling/Adaptive/Simple/SimpleAdaptiveSampler.h"
\ No newline at end of file
+#include "common/Sampling/Adaptive/Simple/SimpleAdaptiveSampler.h"
+#include "common/Sampling/Adaptive/Variance/VarianceAdaptiveSampler.h"
+#include "common/Sampling/Sobol/SobolColorSampler.h"
+#include "common/Sampling/Halton/HaltonColorSampler.h"
+#include "common/Sampling/BlueNoise/BlueNoiseColorSampler.h"
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "common/Sampling/Sobol/SobolColorSampler.h"
+
+namespace
+{
+const int SOBOL_BITS = 32;
+
+// Direction numbers for the first three dimensions, from the primitive polynomials 1, x + 1 and x^2 + x + 1.
+struct SobolDirections
+{
+    SobolDirections()
+    {
+        for (int bit = 0; bit < SOBOL_BITS; ++bit)
+        {
+            directions[0][bit] = 1u << (31 - bit);
+        }
+
+        directions[1][0] = 1u << 31;
+        for (int bit = 1; bit < SOBOL_BITS; ++bit)
+        {
+            directions[1][bit] = directions[1][bit - 1] ^ (directions[1][bit - 1] >> 1);
+        }
+
+        directions[2][0] = 1u << 31;
+        directions[2][1] = 3u << 30;
+        for (int bit = 2; bit < SOBOL_BITS; ++bit)
+        {
+            directions[2][bit] = directions[2][bit - 1] ^ directions[2][bit - 2] ^ (directions[2][bit - 2] >> 2);
+        }
+    }
+
+    uint32_t directions[3][SOBOL_BITS];
+};
+
+const SobolDirections sobolDirections;
+
+uint32_t ReverseBits(uint32_t x)
+{
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+uint32_t Hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Laine-Karras style permutation applied to the bit-reversed value: every output bit only depends on the more
+// significant input bits, which is exactly an Owen scramble.
+uint32_t NestedUniformScramble(uint32_t x, uint32_t seed)
+{
+    x = ReverseBits(x);
+    x += seed;
+    x ^= x * 0x6C50B47Cu;
+    x ^= x * 0xB82F1E52u;
+    x ^= x * 0xC7AFE638u;
+    x ^= x * 0x8D22F6E6u;
+    return ReverseBits(x);
+}
+
+uint32_t SobolSample(uint32_t index, int dimension)
+{
+    uint32_t result = 0;
+    for (int bit = 0; index != 0; ++bit, index >>= 1)
+    {
+        if (index & 1u)
+        {
+            result ^= sobolDirections.directions[dimension][bit];
+        }
+    }
+    return result;
+}
+}
+
+std::unique_ptr<SamplerState> SobolColorSampler::CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const
+{
+    std::unique_ptr<SobolSamplerState> state = make_unique<SobolSamplerState>(generator, maxSamples, dimensions);
+    ResetSampler(*state.get(), generator);
+    return std::move(state);
+}
+
+void SobolColorSampler::ResetSampler(SamplerState& state, RandomGenerator& generator) const
+{
+    ColorSampler::ResetSampler(state, generator);
+    static_cast<SobolSamplerState&>(state).scrambleSeed = generator.Next();
+}
+
+glm::vec3 SobolColorSampler::ComputeSampleCoordinate(SamplerState& state) const
+{
+    const SobolSamplerState& sobolState = static_cast<const SobolSamplerState&>(state);
+
+    // Scrambling the index as well keeps every power of two prefix a (0, m, 2)-net while decorrelating the states.
+    const uint32_t index = NestedUniformScramble(static_cast<uint32_t>(state.samplesComputed), sobolState.scrambleSeed);
+
+    glm::vec3 sample;
+    for (int i = 0; i < 3; ++i)
+    {
+        const uint32_t dimensionSeed = Hash(sobolState.scrambleSeed + 0x9E3779B9u * static_cast<uint32_t>(i + 1));
+        const uint32_t value = NestedUniformScramble(SobolSample(index, i), dimensionSeed);
+        sample[i] = static_cast<float>(value >> 8) * (1.f / 16777216.f);
+    }
+    return sample;
+}
\ No newline at end of file
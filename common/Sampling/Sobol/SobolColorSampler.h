@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/Sampling/ColorSampler.h"
+
+struct SobolSamplerState : public SamplerState
+{
+    SobolSamplerState(RandomGenerator& generator, int inputMax, int inputDim) :
+        SamplerState(generator, inputMax, inputDim), scrambleSeed(0)
+    {
+    }
+
+    uint32_t scrambleSeed;
+};
+
+// Owen-scrambled Sobol points, using Burley's hash-based nested uniform scrambling. Each sampler state draws its own
+// scramble seed, so pixels, area lights and gather hemispheres never share a point set.
+class SobolColorSampler : public ColorSampler
+{
+public:
+    virtual std::unique_ptr<SamplerState> CreateSampler(RandomGenerator& generator, const int maxSamples, const int dimensions) const override;
+    virtual void ResetSampler(SamplerState& state, RandomGenerator& generator) const override;
+    virtual glm::vec3 ComputeSampleCoordinate(SamplerState& state) const override;
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "common/Sampling/Tiles/SampleTiles.h"
+
+SampleTiles::SampleTiles() :
+    tileCount(0), samplesPerTile(0)
+{
+}
+
+void SampleTiles::Assign(const std::vector<std::vector<glm::vec2>>& tiles)
+{
+    Clear();
+    if (tiles.empty())
+    {
+        return;
+    }
+
+    size_t smallestTile = tiles[0].size();
+    for (const std::vector<glm::vec2>& tile : tiles)
+    {
+        smallestTile = std::min(smallestTile, tile.size());
+    }
+    if (smallestTile == 0)
+    {
+        return;
+    }
+
+    tileCount = static_cast<int>(tiles.size());
+    samplesPerTile = static_cast<int>(smallestTile);
+    points.reserve(static_cast<size_t>(tileCount) * samplesPerTile);
+    for (const std::vector<glm::vec2>& tile : tiles)
+    {
+        points.insert(points.end(), tile.begin(), tile.begin() + samplesPerTile);
+    }
+}
+
+void SampleTiles::Clear()
+{
+    tileCount = 0;
+    samplesPerTile = 0;
+    points.clear();
+}
+
+void SampleTiles::ResetCursor(SampleTileCursor& cursor, RandomGenerator& generator) const
+{
+    cursor.tileIndex = (tileCount > 0) ? static_cast<int>(generator.Next() % static_cast<uint32_t>(tileCount)) : 0;
+    cursor.shift = glm::vec2(generator.NextFloat(), generator.NextFloat());
+}
+
+glm::vec2 SampleTiles::GetPoint(const SampleTileCursor& cursor, int sampleIndex) const
+{
+    assert(!IsEmpty());
+    const int tile = (cursor.tileIndex + sampleIndex / samplesPerTile) % tileCount;
+    const glm::vec2 point = points[static_cast<size_t>(tile) * samplesPerTile + sampleIndex % samplesPerTile] + cursor.shift;
+    return point - glm::floor(point);
+}
+
+float SampleTiles::ToroidalDistanceSquared(const glm::vec2& a, const glm::vec2& b)
+{
+    glm::vec2 delta = glm::abs(a - b);
+    delta = glm::min(delta, glm::vec2(1.f) - delta);
+    return glm::dot(delta, delta);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Sampling/Random/RandomGenerator.h"
+
+// Where a sampler state reads from a SampleTiles set: the tile it starts in and the toroidal shift added to every point.
+struct SampleTileCursor
+{
+    SampleTileCursor() : tileIndex(0)
+    {
+    }
+
+    int tileIndex;
+    glm::vec2 shift;
+};
+
+// Equally sized tiles of precomputed points on the unit torus, for samplers whose 2D point sets are too expensive to
+// build per pixel. Every sampler state reads one tile under a random toroidal shift, so neighbouring pixels do not
+// repeat the same pattern. Requests beyond the end of a tile continue in the next tile.
+class SampleTiles
+{
+public:
+    SampleTiles();
+
+    // Takes over the given tiles, cut down to the smallest one so that every tile holds the same number of points.
+    void Assign(const std::vector<std::vector<glm::vec2>>& tiles);
+    void Clear();
+
+    bool IsEmpty() const
+    {
+        return samplesPerTile == 0;
+    }
+
+    // Picks the tile and shift for a new pixel.
+    void ResetCursor(SampleTileCursor& cursor, RandomGenerator& generator) const;
+    // The sampleIndex-th point seen through cursor, in [0, 1)^2.
+    glm::vec2 GetPoint(const SampleTileCursor& cursor, int sampleIndex) const;
+
+    // Distance on the unit torus, which is what the tile generators have to respect so that shifted tiles stay spread out.
+    static float ToroidalDistanceSquared(const glm::vec2& a, const glm::vec2& b);
+
+private:
+    int tileCount;
+    int samplesPerTile;
+    std::vector<glm::vec2> points;
+};
@@ -2,4 +2,11 @@
 
 Camera::Camera()
 {
+}
+
+void Camera::GenerateRays(const glm::vec2* normalizedCoordinates, size_t count, Ray* outputRays) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        outputRays[i] = GenerateRayForNormalizedCoordinates(normalizedCoordinates[i]);
+    }
 }
\ No newline at end of file
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "common/Scene/SceneObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
 
 class Camera : public SceneObject
 {
 public:
     Camera();
 
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const = 0;
+    virtual Ray GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const = 0;
+
+    // Fills outputRays[i] with the ray for normalizedCoordinates[i]. The caller owns both buffers, so a whole tile of
+    // camera rays can be produced without any per-ray allocation.
+    virtual void GenerateRays(const glm::vec2* normalizedCoordinates, size_t count, Ray* outputRays) const;
 };
\ No newline at end of file
@@ -7,15 +7,30 @@ class PerspectiveCamera : public Camera
 public:
     // inputFov is in degrees. 
     PerspectiveCamera(float aspectRatio, float inputFov);
-    virtual std::shared_ptr<class Ray> GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
+    virtual Ray GenerateRayForNormalizedCoordinates(glm::vec2 coordinate) const override;
+    virtual void GenerateRays(const glm::vec2* normalizedCoordinates, size_t count, Ray* outputRays) const override;
 
     void SetZNear(float input);
     void SetZFar(float input);
 
+protected:
+    virtual void UpdateTransformationMatrix() override;
+
 private:
+    void UpdateImagePlane();
+    Ray CreateRay(const glm::vec2& coordinate) const;
+
     float aspectRatio;
     float fov; // fov is stored as radians
 
     float zNear;
     float zFar;
+
+    // Camera basis and image plane extents, refreshed whenever the camera moves so ray generation is just a few FMAs.
+    glm::vec3 cachedOrigin;
+    glm::vec3 cachedForward;
+    glm::vec3 cachedRight;
+    glm::vec3 cachedUp;
+    float planeWidth;
+    float planeHeight;
 };
\ No newline at end of file
@@ -1,17 +1,61 @@
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Acceleration/AccelerationCommon.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+#include "common/Scene/Geometry/Primitives/Triangle/TrianglePacket.h"
+#include "common/Utility/Memory/AlignedAllocator.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
 #include "common/Scene/SceneObject.h"
 #include "common/Intersection/IntersectionState.h"
 
+namespace
+{
+    struct PackingTriangle
+    {
+        glm::vec3 centroid;
+        const PrimitiveBase* triangle;
+    };
+
+    // Splits the range at the median centroid of its widest axis until every piece fits in one packet, so each packet
+    // holds triangles that are close to each other and its bounding box stays tight.
+    void PartitionIntoPackets(std::vector<PackingTriangle>::iterator begin, std::vector<PackingTriangle>::iterator end, std::vector<std::shared_ptr<AccelerationNode>>& packedElements)
+    {
+        const std::ptrdiff_t count = end - begin;
+        if (count <= TrianglePacket::WIDTH) {
+            std::shared_ptr<TrianglePacket> packet = std::allocate_shared<TrianglePacket>(AlignedAllocator<TrianglePacket, 32>());
+            for (auto it = begin; it != end; ++it) {
+                packet->AddTriangle(it->triangle);
+            }
+            packedElements.push_back(std::move(packet));
+            return;
+        }
+
+        glm::vec3 minCentroid = begin->centroid;
+        glm::vec3 maxCentroid = begin->centroid;
+        for (auto it = begin; it != end; ++it) {
+            minCentroid = glm::min(minCentroid, it->centroid);
+            maxCentroid = glm::max(maxCentroid, it->centroid);
+        }
+        const glm::vec3 extent = maxCentroid - minCentroid;
+        const int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : ((extent.y > extent.z) ? 1 : 2);
+
+        // Keep the left side a multiple of the packet width so only the last packet can be partially filled.
+        const std::ptrdiff_t half = ((count / 2 + TrianglePacket::WIDTH - 1) / TrianglePacket::WIDTH) * TrianglePacket::WIDTH;
+        const auto middle = begin + std::min(half, count - 1);
+        std::nth_element(begin, middle, end, [axis](const PackingTriangle& a, const PackingTriangle& b) {
+            return a.centroid[axis] < b.centroid[axis];
+        });
+        PartitionIntoPackets(begin, middle, packedElements);
+        PartitionIntoPackets(middle, end, packedElements);
+    }
+}
+
 MeshObject::MeshObject() :
-    storedMaterial(nullptr)
+    storageMode(MeshStorageModes::PRIMITIVES), storedMaterial(nullptr)
 {
 }
 
 MeshObject::MeshObject(std::shared_ptr<Material> inputMaterial) :
-    storedMaterial(std::move(inputMaterial))
+    storageMode(MeshStorageModes::PRIMITIVES), storedMaterial(std::move(inputMaterial))
 {
 }
 
@@ -32,7 +76,31 @@ void MeshObject::Finalize()
         boundingBox.IncludeBox(elements[i]->GetBoundingBox());
     }
     assert(acceleration);
-    acceleration->Initialize(elements);
+    if (storageMode == MeshStorageModes::PACKED_TRIANGLES) {
+        std::vector<std::shared_ptr<AccelerationNode>> packedElements;
+        CreateTrianglePackets(packedElements);
+        acceleration->Initialize(packedElements);
+    } else {
+        acceleration->Initialize(elements);
+    }
+}
+
+void MeshObject::CreateTrianglePackets(std::vector<std::shared_ptr<AccelerationNode>>& packedElements) const
+{
+    // Anything that isn't a triangle stays an individual node.
+    std::vector<PackingTriangle> triangles;
+    triangles.reserve(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (elements[i]->GetTotalVertices() != 3) {
+            packedElements.push_back(elements[i]);
+            continue;
+        }
+        triangles.push_back({ elements[i]->GetBoundingBox().Center(), elements[i].get() });
+    }
+
+    if (!triangles.empty()) {
+        PartitionIntoPackets(triangles.begin(), triangles.end(), packedElements);
+    }
 }
 
 void MeshObject::CreateAccelerationData(AccelerationTypes perObjectType)
@@ -41,9 +109,19 @@ void MeshObject::CreateAccelerationData(AccelerationTypes perObjectType)
     assert(acceleration);
 }
 
-bool MeshObject::Trace(const SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const
+bool MeshObject::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    return acceleration->Trace(parentObject, localRay, inputRay, outputIntersection);
+}
+
+bool MeshObject::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay) const
+{
+    return acceleration->Occluded(parentObject, localRay, inputRay);
+}
+
+void MeshObject::SetStorageMode(MeshStorageModes input)
 {
-    return acceleration->Trace(parentObject, inputRay, outputIntersection);
+    storageMode = input;
 }
 
 const Material* MeshObject::GetMaterial() const
@@ -2,6 +2,7 @@
 
 #include "common/common.h"
 #include "common/Acceleration/AccelerationCommon.h"
+#include "common/Scene/Geometry/Mesh/MeshStorageModes.h"
 
 class MeshObject: public std::enable_shared_from_this<MeshObject>, public AccelerationNode
 {
@@ -16,6 +17,10 @@ public:
     void AddPrimitive(std::shared_ptr<class PrimitiveBase> newPrimitive);
     virtual void CreateAccelerationData(AccelerationTypes perObjectType);
 
+    // Must be set before Finalize() to have an effect.
+    void SetStorageMode(MeshStorageModes input);
+    MeshStorageModes GetStorageMode() const { return storageMode; }
+
     virtual Box GetBoundingBox() const override
     {
         return boundingBox;
@@ -24,7 +29,8 @@ public:
     virtual void SetMaterial(std::shared_ptr<class Material> inputMaterial);
     virtual const class Material* GetMaterial() const;
 
-    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const override;
 
     friend class SceneObject;
 protected:
@@ -34,6 +40,10 @@ protected:
     class std::shared_ptr<class AccelerationStructure> acceleration;
 
 private:
+    void CreateTrianglePackets(std::vector<std::shared_ptr<AccelerationNode>>& packedElements) const;
+
+    MeshStorageModes storageMode;
+
     std::shared_ptr<class Material> storedMaterial;
     std::string meshName;
 };
@@ -0,0 +1,9 @@
+#pragma once
+
+enum class MeshStorageModes
+{
+    // Every primitive is its own acceleration node.
+    PRIMITIVES,
+    // Triangles are grouped into structure-of-arrays packets that are intersected several at a time.
+    PACKED_TRIANGLES
+};
@@ -55,6 +55,12 @@ public:
         return N;
     }
 
+    virtual glm::vec3 GetVertexPosition(int index) const override
+    {
+        assert(index >= 0 && index < N);
+        return positions[index];
+    }
+
     virtual void Finalize() override
     {
         UpdateBoundingBox();
@@ -12,6 +12,7 @@ public:
     virtual void SetVertexUV(int index, glm::vec2 uv) = 0;
     virtual void SetVertexTangentBitangent(int index, glm::vec3 tangent, glm::vec3 bitangent) = 0;
     virtual int GetTotalVertices() const = 0;
+    virtual glm::vec3 GetVertexPosition(int index) const = 0;
     virtual void Finalize() = 0;
 
     virtual bool HasVertexNormals() const = 0;
@@ -1,5 +1,6 @@
 #include "common/Scene/Geometry/Primitives/Triangle/Triangle.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
 #include "common/Intersection/IntersectionState.h"
 
 Triangle::Triangle(class MeshObject* inputParent):
@@ -14,13 +15,12 @@ glm::vec3 Triangle::GetPrimitiveNormal() const
     return glm::normalize(glm::cross(edge1, edge2));
 }
 
-bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+bool Triangle::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
 {
     DIAGNOSTICS_STAT(DiagnosticsType::TRIANGLE_INTERSECTIONS);
     assert(parentObject);
-    // Convert ray into object space.
-    const glm::vec3 rayPos = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetPosition());
-    const glm::vec3 rayDir = glm::vec3(parentObject->GetWorldToObjectMatrix() * inputRay->GetForwardDirection());
+    const glm::vec3& rayPos = localRay.position;
+    const glm::vec3& rayDir = localRay.direction;
 
     // Use Moller-Trumbore Intersection (Fast, Minimum Storage Ray/Triangle Intersection)
     // Paper: http://www.cs.virginia.edu/~gfx/Courses/2003/ImageSynthesis/papers/Acceleration/Fast%20MinimumStorage%20RayTriangle%20Intersection.pdf
@@ -36,7 +36,7 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
 
     const float invDet = 1.f / det;
 
-    const glm::vec3 tvec = glm::vec3(rayPos) - positions[0];
+    const glm::vec3 tvec = rayPos - positions[0];
     const float u = glm::dot(tvec, pvec) * invDet;
     if (u < 0.f || u > 1.f) {
         return false;
@@ -49,7 +49,7 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
     }
 
     const float t = glm::dot(edge2, qvec) * invDet;
-    if (t - inputRay->GetMaxT() > SMALL_EPSILON || t < -SMALL_EPSILON) {
+    if (t - inputRay->GetMaxT() > SMALL_EPSILON || t - inputRay->GetMinT() < -SMALL_EPSILON) {
         return false;
     }
 
@@ -63,10 +63,9 @@ bool Triangle::Trace(const SceneObject* parentObject, Ray* inputRay, Intersectio
         outputIntersection->intersectedPrimitive = this;
         outputIntersection->hasIntersection = true;
 
-        outputIntersection->primitiveIntersectionWeights.clear();
-        outputIntersection->primitiveIntersectionWeights.emplace_back(1.f - u - v);
-        outputIntersection->primitiveIntersectionWeights.emplace_back(u);
-        outputIntersection->primitiveIntersectionWeights.emplace_back(v);
+        outputIntersection->primitiveIntersectionWeights[0] = 1.f - u - v;
+        outputIntersection->primitiveIntersectionWeights[1] = u;
+        outputIntersection->primitiveIntersectionWeights[2] = v;
     }
 
     return true;
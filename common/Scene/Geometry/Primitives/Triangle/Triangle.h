@@ -6,6 +6,6 @@ class Triangle: public Primitive<3>
 {
 public:
     Triangle(class MeshObject* inputParent);
-    virtual bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
     virtual glm::vec3 GetPrimitiveNormal() const override;
 };
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "common/Scene/Geometry/Primitives/Triangle/TrianglePacket.h"
+#include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
+#include "common/Scene/SceneObject.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
+#include "common/Intersection/IntersectionState.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRIANGLE_PACKET_SIMD 1
+namespace
+{
+    // Thin wrapper so the kernel below reads like scalar code; operators on the raw vector types are not portable.
+    struct PacketFloat
+    {
+        __m256 value;
+    };
+    inline PacketFloat PacketLoad(const float* input) { return { _mm256_loadu_ps(input) }; }
+    inline PacketFloat PacketSet(float input) { return { _mm256_set1_ps(input) }; }
+    inline void PacketStore(float* output, PacketFloat input) { _mm256_storeu_ps(output, input.value); }
+    inline PacketFloat operator+(PacketFloat a, PacketFloat b) { return { _mm256_add_ps(a.value, b.value) }; }
+    inline PacketFloat operator-(PacketFloat a, PacketFloat b) { return { _mm256_sub_ps(a.value, b.value) }; }
+    inline PacketFloat operator*(PacketFloat a, PacketFloat b) { return { _mm256_mul_ps(a.value, b.value) }; }
+    inline PacketFloat operator/(PacketFloat a, PacketFloat b) { return { _mm256_div_ps(a.value, b.value) }; }
+    inline PacketFloat operator|(PacketFloat a, PacketFloat b) { return { _mm256_or_ps(a.value, b.value) }; }
+    inline PacketFloat operator&(PacketFloat a, PacketFloat b) { return { _mm256_and_ps(a.value, b.value) }; }
+    inline PacketFloat PacketLess(PacketFloat a, PacketFloat b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ) }; }
+    inline PacketFloat PacketGreater(PacketFloat a, PacketFloat b) { return { _mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ) }; }
+    inline int PacketMask(PacketFloat input) { return _mm256_movemask_ps(input.value); }
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TRIANGLE_PACKET_SIMD 1
+namespace
+{
+    struct PacketFloat
+    {
+        __m128 value;
+    };
+    inline PacketFloat PacketLoad(const float* input) { return { _mm_loadu_ps(input) }; }
+    inline PacketFloat PacketSet(float input) { return { _mm_set1_ps(input) }; }
+    inline void PacketStore(float* output, PacketFloat input) { _mm_storeu_ps(output, input.value); }
+    inline PacketFloat operator+(PacketFloat a, PacketFloat b) { return { _mm_add_ps(a.value, b.value) }; }
+    inline PacketFloat operator-(PacketFloat a, PacketFloat b) { return { _mm_sub_ps(a.value, b.value) }; }
+    inline PacketFloat operator*(PacketFloat a, PacketFloat b) { return { _mm_mul_ps(a.value, b.value) }; }
+    inline PacketFloat operator/(PacketFloat a, PacketFloat b) { return { _mm_div_ps(a.value, b.value) }; }
+    inline PacketFloat operator|(PacketFloat a, PacketFloat b) { return { _mm_or_ps(a.value, b.value) }; }
+    inline PacketFloat operator&(PacketFloat a, PacketFloat b) { return { _mm_and_ps(a.value, b.value) }; }
+    inline PacketFloat PacketLess(PacketFloat a, PacketFloat b) { return { _mm_cmplt_ps(a.value, b.value) }; }
+    inline PacketFloat PacketGreater(PacketFloat a, PacketFloat b) { return { _mm_cmpgt_ps(a.value, b.value) }; }
+    inline int PacketMask(PacketFloat input) { return _mm_movemask_ps(input.value); }
+}
+#else
+#define TRIANGLE_PACKET_SIMD 0
+#endif
+
+TrianglePacket::TrianglePacket():
+    count(0)
+{
+    // Unused lanes hold degenerate triangles, which always fail the determinant test.
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int i = 0; i < WIDTH; ++i) {
+            vertex0[axis][i] = 0.f;
+            edge1[axis][i] = 0.f;
+            edge2[axis][i] = 0.f;
+        }
+    }
+    for (int i = 0; i < WIDTH; ++i) {
+        triangles[i] = nullptr;
+    }
+}
+
+bool TrianglePacket::AddTriangle(const PrimitiveBase* triangle)
+{
+    assert(triangle && triangle->GetTotalVertices() == 3);
+    if (count == WIDTH) {
+        return false;
+    }
+
+    const glm::vec3 position0 = triangle->GetVertexPosition(0);
+    const glm::vec3 triangleEdge1 = triangle->GetVertexPosition(1) - position0;
+    const glm::vec3 triangleEdge2 = triangle->GetVertexPosition(2) - position0;
+    for (int axis = 0; axis < 3; ++axis) {
+        vertex0[axis][count] = position0[axis];
+        edge1[axis][count] = triangleEdge1[axis];
+        edge2[axis][count] = triangleEdge2[axis];
+    }
+
+    triangles[count] = triangle;
+    boundingBox.IncludeBox(triangle->GetBoundingBox());
+    ++count;
+    return true;
+}
+
+Box TrianglePacket::GetBoundingBox() const
+{
+    return boundingBox;
+}
+
+int TrianglePacket::IntersectLanes(const glm::vec3& rayPos, const glm::vec3& rayDir, float* tValues, float* uValues, float* vValues) const
+{
+    // Moller-Trumbore, evaluated with exactly the same operation order as Triangle::Trace so results match bit for bit.
+#if TRIANGLE_PACKET_SIMD
+    const PacketFloat dirX = PacketSet(rayDir.x), dirY = PacketSet(rayDir.y), dirZ = PacketSet(rayDir.z);
+    const PacketFloat e1X = PacketLoad(edge1[0]), e1Y = PacketLoad(edge1[1]), e1Z = PacketLoad(edge1[2]);
+    const PacketFloat e2X = PacketLoad(edge2[0]), e2Y = PacketLoad(edge2[1]), e2Z = PacketLoad(edge2[2]);
+
+    const PacketFloat pvecX = dirY * e2Z - e2Y * dirZ;
+    const PacketFloat pvecY = dirZ * e2X - e2Z * dirX;
+    const PacketFloat pvecZ = dirX * e2Y - e2X * dirY;
+    const PacketFloat det = e1X * pvecX + e1Y * pvecY + e1Z * pvecZ;
+    const PacketFloat invDet = PacketSet(1.f) / det;
+
+    const PacketFloat tvecX = PacketSet(rayPos.x) - PacketLoad(vertex0[0]);
+    const PacketFloat tvecY = PacketSet(rayPos.y) - PacketLoad(vertex0[1]);
+    const PacketFloat tvecZ = PacketSet(rayPos.z) - PacketLoad(vertex0[2]);
+    const PacketFloat u = (tvecX * pvecX + tvecY * pvecY + tvecZ * pvecZ) * invDet;
+
+    const PacketFloat qvecX = tvecY * e1Z - e1Y * tvecZ;
+    const PacketFloat qvecY = tvecZ * e1X - e1Z * tvecX;
+    const PacketFloat qvecZ = tvecX * e1Y - e1X * tvecY;
+    const PacketFloat v = (dirX * qvecX + dirY * qvecY + dirZ * qvecZ) * invDet;
+    const PacketFloat t = (e2X * qvecX + e2Y * qvecY + e2Z * qvecZ) * invDet;
+
+    const PacketFloat zero = PacketSet(0.f);
+    const PacketFloat one = PacketSet(1.f);
+    const PacketFloat missed = (PacketGreater(det, PacketSet(-SMALL_EPSILON)) & PacketLess(det, PacketSet(SMALL_EPSILON))) |
+        PacketLess(u, zero) | PacketGreater(u, one) | PacketLess(v, zero) | PacketGreater(u + v, one);
+
+    PacketStore(tValues, t);
+    PacketStore(uValues, u);
+    PacketStore(vValues, v);
+    return ~PacketMask(missed) & ((1 << count) - 1);
+#else
+    int validLanes = 0;
+    for (int i = 0; i < count; ++i) {
+        const glm::vec3 triangleEdge1(edge1[0][i], edge1[1][i], edge1[2][i]);
+        const glm::vec3 triangleEdge2(edge2[0][i], edge2[1][i], edge2[2][i]);
+        const glm::vec3 pvec = glm::cross(rayDir, triangleEdge2);
+        const float det = glm::dot(triangleEdge1, pvec);
+        if (det > -SMALL_EPSILON && det < SMALL_EPSILON) {
+            continue;
+        }
+
+        const float invDet = 1.f / det;
+        const glm::vec3 tvec = rayPos - glm::vec3(vertex0[0][i], vertex0[1][i], vertex0[2][i]);
+        const float u = glm::dot(tvec, pvec) * invDet;
+        if (u < 0.f || u > 1.f) {
+            continue;
+        }
+
+        const glm::vec3 qvec = glm::cross(tvec, triangleEdge1);
+        const float v = glm::dot(rayDir, qvec) * invDet;
+        if (v < 0.f || u + v > 1.f) {
+            continue;
+        }
+
+        tValues[i] = glm::dot(triangleEdge2, qvec) * invDet;
+        uValues[i] = u;
+        vValues[i] = v;
+        validLanes |= 1 << i;
+    }
+    return validLanes;
+#endif
+}
+
+bool TrianglePacket::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    for (int i = 0; i < count; ++i) {
+        DIAGNOSTICS_STAT(DiagnosticsType::TRIANGLE_INTERSECTIONS);
+    }
+    assert(parentObject);
+
+    alignas(32) float tValues[WIDTH];
+    alignas(32) float uValues[WIDTH];
+    alignas(32) float vValues[WIDTH];
+    const int validLanes = IntersectLanes(localRay.position, localRay.direction, tValues, uValues, vValues);
+    if (!validLanes) {
+        return false;
+    }
+
+    // Resolve lanes in order so ties between triangles go the same way as testing them one by one.
+    bool hitObject = false;
+    for (int i = 0; i < count; ++i) {
+        if (!(validLanes & (1 << i))) {
+            continue;
+        }
+
+        const float t = tValues[i];
+        if (t - inputRay->GetMaxT() > SMALL_EPSILON || t - inputRay->GetMinT() < -SMALL_EPSILON) {
+            continue;
+        }
+
+        if (!outputIntersection) {
+            return true;
+        }
+
+        if (t - outputIntersection->intersectionT > SMALL_EPSILON) {
+            continue;
+        }
+        outputIntersection->intersectionRay = *inputRay;
+        outputIntersection->primitiveParent = parentObject;
+        outputIntersection->intersectionT = t;
+        outputIntersection->intersectedPrimitive = triangles[i];
+        outputIntersection->hasIntersection = true;
+
+        outputIntersection->primitiveIntersectionWeights[0] = 1.f - uValues[i] - vValues[i];
+        outputIntersection->primitiveIntersectionWeights[1] = uValues[i];
+        outputIntersection->primitiveIntersectionWeights[2] = vValues[i];
+        hitObject = true;
+    }
+    return hitObject;
+}
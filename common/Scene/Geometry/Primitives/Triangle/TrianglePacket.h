@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Acceleration/AccelerationNode.h"
+
+#if defined(__AVX__)
+#define TRIANGLE_PACKET_WIDTH 8
+#else
+#define TRIANGLE_PACKET_WIDTH 4
+#endif
+
+// Up to TRIANGLE_PACKET_WIDTH triangles of one mesh stored as a structure of arrays so a single ray can be tested
+// against all of them at once. Uses AVX when compiled with it, SSE2 otherwise, and plain scalar code as a last resort.
+// Hits are resolved in the same order and with the same tolerances as Triangle::Trace.
+class TrianglePacket : public AccelerationNode
+{
+public:
+    static const int WIDTH = TRIANGLE_PACKET_WIDTH;
+
+    TrianglePacket();
+
+    // Returns false once the packet is full.
+    bool AddTriangle(const class PrimitiveBase* triangle);
+    int GetTotalTriangles() const { return count; }
+
+    virtual Box GetBoundingBox() const override;
+    virtual bool Trace(const class SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+
+private:
+    // Returns a bit per lane for which the ray crosses the triangle; t, u and v are only meaningful for those lanes.
+    int IntersectLanes(const glm::vec3& rayPos, const glm::vec3& rayDir, float* tValues, float* uValues, float* vValues) const;
+
+    alignas(32) float vertex0[3][WIDTH];
+    alignas(32) float edge1[3][WIDTH];
+    alignas(32) float edge2[3][WIDTH];
+
+    const class PrimitiveBase* triangles[WIDTH];
+    int count;
+    Box boundingBox;
+};
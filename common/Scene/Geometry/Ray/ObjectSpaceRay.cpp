@@ -0,0 +1,25 @@
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
+#include "common/Scene/Geometry/Ray/Ray.h"
+
+ObjectSpaceRay::ObjectSpaceRay(const Ray& worldRay, TraceMask* mask):
+    position(worldRay.GetRayOrigin()), direction(worldRay.GetRayDirection()), inverseDirection(worldRay.GetInverseDirection()), traceMask(mask)
+{
+    for (int i = 0; i < 3; ++i) {
+        directionIsNegative[i] = inverseDirection[i] < 0.f;
+    }
+}
+
+ObjectSpaceRay::ObjectSpaceRay(const glm::mat4& worldToObjectMatrix, const Ray& worldRay):
+    position(worldToObjectMatrix * worldRay.GetPosition()), direction(worldToObjectMatrix * worldRay.GetForwardDirection()), traceMask(nullptr)
+{
+    ComputeInverseDirection();
+}
+
+void ObjectSpaceRay::ComputeInverseDirection()
+{
+    for (int i = 0; i < 3; ++i) {
+        const float component = (std::abs(direction[i]) < SMALL_EPSILON) ? std::copysign(SMALL_EPSILON, direction[i]) : direction[i];
+        inverseDirection[i] = 1.f / component;
+        directionIsNegative[i] = component < 0.f;
+    }
+}
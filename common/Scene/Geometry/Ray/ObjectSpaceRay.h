@@ -0,0 +1,26 @@
+#pragma once
+
+#include "common/common.h"
+
+// A ray expressed in the space of the nodes that are being traced. SceneObject::Trace builds one per object so that
+// acceleration structures and primitives never transform the ray themselves. The direction is not renormalized, so
+// distances along it match distances along the world space ray.
+struct ObjectSpaceRay
+{
+    // Keeps the ray in world space; used for the scene level acceleration structure.
+    explicit ObjectSpaceRay(const class Ray& worldRay, class TraceMask* mask = nullptr);
+    ObjectSpaceRay(const glm::mat4& worldToObjectMatrix, const class Ray& worldRay);
+
+    glm::vec3 position;
+    glm::vec3 direction;
+
+    // Near-zero direction components are clamped before inverting so slab tests never produce NaNs.
+    glm::vec3 inverseDirection;
+    bool directionIsNegative[3];
+
+    // Scene objects that this traversal has already missed. Optional; only the scene level ray carries one.
+    class TraceMask* traceMask;
+
+private:
+    void ComputeInverseDirection();
+};
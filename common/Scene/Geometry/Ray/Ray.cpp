@@ -1,50 +1,29 @@
 #include "common/Scene/Geometry/Ray/Ray.h"
 
 Ray::Ray() :
-    rayDirection(glm::vec3(0.f, 0.f, -1.f)), maxT(std::numeric_limits<float>::max())
+    origin(0.f, 0.f, 0.f), minT(0.f), maxT(std::numeric_limits<float>::max())
 {
-    position = glm::vec4(0.f, 0.f, 0.f, 1.f);
+    SetRayDirection(glm::vec3(0.f, 0.f, -1.f));
 }
 
 Ray::Ray(glm::vec3 inputPosition, glm::vec3 inputDirection, float inputMaxT):
-    rayDirection(glm::normalize(inputDirection)), maxT(inputMaxT)
+    origin(inputPosition), minT(0.f), maxT(inputMaxT)
 {
-    position = glm::vec4(inputPosition, 1.f);
+    SetRayDirection(glm::normalize(inputDirection));
 }
 
-glm::vec4 Ray::GetForwardDirection() const
+void Ray::SetRayDirection(const glm::vec3& input)
 {
-    return glm::vec4(GetRayDirection(), 0.f);
-}
-
-glm::vec3 Ray::GetRayDirection() const
-{
-    return rayDirection;
-}
-
-float Ray::GetMaxT() const
-{
-    return maxT;
-}
-
-void Ray::SetMaxT(float input)
-{
-    maxT = input;
+    rayDirection = input;
+    for (int i = 0; i < 3; ++i) {
+        const float component = (std::abs(rayDirection[i]) < SMALL_EPSILON) ? std::copysign(SMALL_EPSILON, rayDirection[i]) : rayDirection[i];
+        inverseDirection[i] = 1.f / component;
+    }
 }
 
 glm::vec3 Ray::GetRayPosition(float t) const
 {
-    return glm::vec3(position) + t * rayDirection;
-}
-
-void Ray::SetRayMask(uint64_t objectId)
-{
-    traceMask[objectId] = true;
-}
-
-bool Ray::IsObjectMasked(uint64_t objectId)
-{
-    return traceMask[objectId];
+    return origin + t * rayDirection;
 }
 
 glm::vec3 Ray::RefractRay(const glm::vec3& normal, float n1, float& n2) const
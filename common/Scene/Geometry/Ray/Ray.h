@@ -1,31 +1,38 @@
 #pragma once
 
-#include "common/Scene/SceneObject.h"
+#include "common/common.h"
 
-class Ray : public SceneObject
+// Plain value type: copying a ray never allocates. Objects that were already missed during a traversal are tracked
+// separately by TraceMask.
+class Ray
 {
 public:
     Ray();
     Ray(glm::vec3 inputPosition, glm::vec3 inputDirection, float inputMaxT = std::numeric_limits<float>::max());
 
-    void SetRayPosition(const glm::vec3& input) { position = glm::vec4(input, 1.f); }
-    void SetRayDirection(const glm::vec3& input) { rayDirection = input; } 
+    void SetRayPosition(const glm::vec3& input) { origin = input; }
+    void SetRayDirection(const glm::vec3& input);
 
-    virtual glm::vec4 GetForwardDirection() const override;
-    glm::vec3 GetRayDirection() const;
+    const glm::vec3& GetRayOrigin() const { return origin; }
+    glm::vec3 GetRayDirection() const { return rayDirection; }
+    const glm::vec3& GetInverseDirection() const { return inverseDirection; }
+    glm::vec4 GetPosition() const { return glm::vec4(origin, 1.f); }
+    glm::vec4 GetForwardDirection() const { return glm::vec4(rayDirection, 0.f); }
 
     glm::vec3 GetRayPosition(float t) const;
 
-    float GetMaxT() const;
-    void SetMaxT(float input);
+    float GetMinT() const { return minT; }
+    void SetMinT(float input) { minT = input; }
 
-    void SetRayMask(uint64_t objectId);
-    bool IsObjectMasked(uint64_t objectId);
+    float GetMaxT() const { return maxT; }
+    void SetMaxT(float input) { maxT = input; }
 
     glm::vec3 RefractRay(const glm::vec3& normal, float n1, float& n2) const;
 private:
+    glm::vec3 origin;
     glm::vec3 rayDirection;
+    // Near-zero direction components are clamped before inverting so slab tests never produce NaNs.
+    glm::vec3 inverseDirection;
+    float minT;
     float maxT;
-
-    std::unordered_map<uint64_t, bool> traceMask;
-};
\ No newline at end of file
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "common/common.h"
+
+// Remembers which scene objects a single traversal has already missed, keyed by the dense index the scene hands out
+// in Scene::Finalize. Lives on the stack of Scene::Trace; objects past the fixed capacity are simply never masked.
+class TraceMask
+{
+public:
+    static const int CAPACITY = 256;
+
+    TraceMask()
+    {
+        for (int i = 0; i < WORDS; ++i) {
+            bits[i] = 0;
+        }
+    }
+
+    bool IsMasked(int index) const
+    {
+        return index >= 0 && index < CAPACITY && (bits[index >> 6] & (uint64_t(1) << (index & 63)));
+    }
+
+    void SetMasked(int index)
+    {
+        if (index >= 0 && index < CAPACITY) {
+            bits[index >> 6] |= uint64_t(1) << (index & 63);
+        }
+    }
+
+private:
+    static const int WORDS = CAPACITY / 64;
+    uint64_t bits[WORDS];
+};
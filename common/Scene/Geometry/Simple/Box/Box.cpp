@@ -1,6 +1,7 @@
 #include "common/Scene/Geometry/Simple/Box/Box.h"
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
 #include "common/Intersection/IntersectionState.h"
 
 Box::Box() :
@@ -30,17 +31,11 @@ glm::vec3 Box::Center() const
     return 0.5f * (minVertex + maxVertex);
 }
 
-bool Box::Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const
+bool Box::Trace(const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const
 {
     DIAGNOSTICS_STAT(DiagnosticsType::BOX_INTERSECTIONS);
-    glm::mat4 spaceTransform(1.f);
-    if (parentObject) {
-        spaceTransform = parentObject->GetWorldToObjectMatrix();
-    }
-
-    // Convert ray into object space.
-    const glm::vec3 rayPos = glm::vec3(spaceTransform * inputRay->GetPosition());
-    const glm::vec3 rayDir = glm::vec3(spaceTransform * inputRay->GetForwardDirection());
+    const glm::vec3& rayPos = localRay.position;
+    const glm::vec3& rayDir = localRay.direction;
 
     //std::cout << "Trace Box Ray: " << glm::to_string(rayPos) << " " << glm::to_string(rayDir) << std::endl;
     //std::cout << "  Box: " << glm::to_string(minVertex) << " " << glm::to_string(maxVertex) << std::endl;
@@ -60,8 +55,8 @@ bool Box::Trace(const class SceneObject* parentObject, class Ray* inputRay, stru
             continue;
         }
 
-        float dimMinT = (minVertex[i] - rayPos[i]) / rayDir[i];
-        float dimMaxT = (maxVertex[i] - rayPos[i]) / rayDir[i];
+        float dimMinT = (minVertex[i] - rayPos[i]) * localRay.inverseDirection[i];
+        float dimMaxT = (maxVertex[i] - rayPos[i]) * localRay.inverseDirection[i];
 
         if (dimMaxT - dimMinT < SMALL_EPSILON) {
             std::swap(dimMinT, dimMaxT);
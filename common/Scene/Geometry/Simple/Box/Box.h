@@ -13,7 +13,7 @@ public:
     glm::vec3 Center() const;
     float Volume() const;
 
-    bool Trace(const class SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
+    bool Trace(const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const;
     
     Box Expand(float delta) const;
     Box Transform(glm::mat4 transformation) const;
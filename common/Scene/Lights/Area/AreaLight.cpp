@@ -3,17 +3,19 @@
 AreaLight::AreaLight(const glm::vec2& size):
     samplesToUse(4), lightSize(size)
 {
-    sampler = make_unique<JitterColorSampler>();
-    sampler->SetGridSize(glm::ivec3(2, 2, 1));
+    jitterSampler = std::make_shared<JitterColorSampler>();
+    jitterSampler->SetGridSize(glm::ivec3(2, 2, 1));
+    sampler = jitterSampler;
 }
 
 void AreaLight::ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const
 {
     origin += normal * LARGE_EPSILON;
-    std::random_device rd;
-    std::unique_ptr<SamplerState> sampleState = sampler->CreateSampler(rd, samplesToUse, 2);
+    ScopedSamplerState scopedState(*sampler.get(), RandomGenerator::GetThreadGenerator(), samplesToUse, 2);
+    SamplerState& sampleState = scopedState.Get();
     for (int i = 0; i < samplesToUse; ++i) {
-        glm::vec3 sample = sampler->ComputeSampleCoordinate(*sampleState.get()) - 0.5f;
+        glm::vec3 sample = sampler->ComputeSampleCoordinate(sampleState) - 0.5f;
+        ++sampleState.samplesComputed;
         sample.x *= lightSize.x;
         sample.y *= lightSize.y;
         sample.z = 0.f;
@@ -35,12 +37,18 @@ float AreaLight::ComputeLightAttenuation(glm::vec3 origin) const
     return 1.f / static_cast<float>(samplesToUse);
 }
 
-void AreaLight::GenerateRandomPhotonRay(Ray& ray) const
+void AreaLight::GenerateRandomPhotonRay(Ray& ray, RandomGenerator& generator) const
 {
 }
 
 void AreaLight::SetSamplerAttributes(glm::ivec3 inputGridSize, int numSamples)
 {
-    sampler->SetGridSize(inputGridSize);
+    jitterSampler->SetGridSize(inputGridSize);
     samplesToUse = numSamples;
+}
+
+void AreaLight::SetSampler(std::shared_ptr<ColorSampler> inputSampler)
+{
+    assert(inputSampler);
+    sampler = std::move(inputSampler);
 }
\ No newline at end of file
@@ -11,12 +11,15 @@ public:
     virtual void ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const override;
     virtual float ComputeLightAttenuation(glm::vec3 origin) const override;
 
-    virtual void GenerateRandomPhotonRay(Ray& ray) const override;
+    virtual void GenerateRandomPhotonRay(Ray& ray, RandomGenerator& generator) const override;
 
     // Sampler Attributes
     void SetSamplerAttributes(glm::ivec3 inputGridSize, int numSamples);
+    // Replaces the default jitter pattern, e.g. with a low-discrepancy sampler. The grid size no longer applies.
+    void SetSampler(std::shared_ptr<ColorSampler> inputSampler);
 private:
-    std::unique_ptr<JitterColorSampler> sampler;
+    std::shared_ptr<JitterColorSampler> jitterSampler;
+    std::shared_ptr<ColorSampler> sampler;
     int samplesToUse;
     glm::vec2 lightSize;
 };
\ No newline at end of file
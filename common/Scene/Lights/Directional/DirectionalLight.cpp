@@ -11,6 +11,6 @@ float DirectionalLight::ComputeLightAttenuation(glm::vec3 origin) const
     return 1.f;
 }
 
-void DirectionalLight::GenerateRandomPhotonRay(Ray& ray) const
+void DirectionalLight::GenerateRandomPhotonRay(Ray& ray, RandomGenerator& generator) const
 {
 }
\ No newline at end of file
@@ -8,5 +8,5 @@ public:
     virtual void ComputeSampleRays(std::vector<Ray>& output, glm::vec3 origin, glm::vec3 normal) const override;
     virtual float ComputeLightAttenuation(glm::vec3 origin) const override;
 
-    virtual void GenerateRandomPhotonRay(Ray& ray) const override;
+    virtual void GenerateRandomPhotonRay(Ray& ray, RandomGenerator& generator) const override;
 };
\ No newline at end of file
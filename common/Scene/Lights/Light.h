@@ -2,6 +2,7 @@
 
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Sampling/Random/RandomGenerator.h"
 
 class Light : public SceneObject
 {
@@ -13,7 +14,7 @@ public:
     void SetLightColor(glm::vec3 input);
 
     // Photon Mapping Utility Functions
-    virtual void GenerateRandomPhotonRay(Ray& ray) const = 0;
+    virtual void GenerateRandomPhotonRay(Ray& ray, RandomGenerator& generator) const = 0;
 
 protected:
     glm::vec3 lightColor;
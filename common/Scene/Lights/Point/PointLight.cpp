@@ -15,18 +15,14 @@ float PointLight::ComputeLightAttenuation(glm::vec3 origin) const
     return 1.f;
 }
 
-void PointLight::GenerateRandomPhotonRay(Ray& ray) const
+void PointLight::GenerateRandomPhotonRay(Ray& ray, RandomGenerator& generator) const
 {
-	std::random_device rd;
-	std::mt19937 mt(rd());
-	std::uniform_real_distribution<float> dist(-1.0, std::nextafter(1.f, FLT_MAX));
-
 	float x, y, z;
 	do 
 	{
-		x = dist(mt);
-		y = dist(mt);
-		z = dist(mt);
+		x = 2.f * generator.NextFloatClosed() - 1.f;
+		y = 2.f * generator.NextFloatClosed() - 1.f;
+		z = 2.f * generator.NextFloatClosed() - 1.f;
 	} while (x*x + y*y + z*z > 1.f);
 
 	const glm::vec3 lightPosition = glm::vec3(GetPosition());
@@ -1,9 +1,13 @@
 #include "common/Scene/Scene.h"
+#include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
+#include "common/Scene/Geometry/Ray/TraceMask.h"
 #include "common/Scene/Geometry/Primitives/PrimitiveBase.h"
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Rendering/Material/Material.h"
 #include "common/Acceleration/AccelerationCommon.h"
+#include "common/Sampling/Random/RandomGenerator.h"
 
 void Scene::GenerateDefaultAccelerationData()
 {
@@ -27,47 +31,135 @@ AccelerationStructure* Scene::GenerateAccelerationData(AccelerationTypes inputTy
 }
 
 
+// A reflection or refraction ray waiting to be traced into the state that will hold its hit.
+struct Scene::SecondaryRay
+{
+    Ray ray;
+    IntersectionState* state;
+};
+
 bool Scene::Trace(class Ray* inputRay, IntersectionState* outputIntersection) const
 {
     assert(inputRay);
-    DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
+    if (outputIntersection == nullptr) 
+	{
+        return Occluded(inputRay);
+    }
 
-    bool didIntersect = acceleration->Trace(nullptr, inputRay, outputIntersection);
-    if (outputIntersection != nullptr && didIntersect) 
+    if (!Intersect(inputRay, outputIntersection)) 
 	{
-        const MeshObject* intersectedMesh = outputIntersection->intersectedPrimitive->GetParentMeshObject();
-        assert(intersectedMesh);
-        const Material* currentMaterial = intersectedMesh->GetMaterial();
-        assert(currentMaterial);
-
-        const glm::vec3 intersectionPoint = outputIntersection->intersectionRay.GetRayPosition(outputIntersection->intersectionT);
-        const float NdR = glm::dot(inputRay->GetRayDirection(), outputIntersection->ComputeNormal());
-        // send out reflection ray.
-        if (currentMaterial->IsReflective() && outputIntersection->remainingReflectionBounces > 0) 
-		{
-            outputIntersection->reflectionIntersection = std::make_shared<IntersectionState>(outputIntersection->remainingReflectionBounces - 1, outputIntersection->remainingRefractionBounces);
+        return false;
+    }
 
-            Ray reflectionRay;
-            PerformRaySpecularReflection(reflectionRay, *inputRay, intersectionPoint, NdR, *outputIntersection);
-            Trace(&reflectionRay, outputIntersection->reflectionIntersection.get());
-        }
+    // Shading never calls back into Trace while this runs, but leave anything below our base alone all the same.
+    thread_local std::vector<SecondaryRay> pendingRays;
+    const size_t stackBase = pendingRays.size();
 
-        // send out refraction ray.
-        if (currentMaterial->IsTransmissive() && outputIntersection->remainingRefractionBounces > 0) 
+    PushSecondaryRays(*inputRay, *outputIntersection, pendingRays);
+    while (pendingRays.size() > stackBase) 
+	{
+        SecondaryRay secondary = pendingRays.back();
+        pendingRays.pop_back();
+        if (Intersect(&secondary.ray, secondary.state)) 
 		{
-            outputIntersection->refractionIntersection = std::make_shared<IntersectionState>(outputIntersection->remainingReflectionBounces, outputIntersection->remainingRefractionBounces - 1);
+            PushSecondaryRays(secondary.ray, *secondary.state, pendingRays);
+        }
+    }
+    return true;
+}
 
-            // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
-            float targetIOR = (NdR < SMALL_EPSILON) ? currentMaterial->GetIOR() : 1.f;
+bool Scene::Occluded(class Ray* inputRay) const
+{
+    assert(inputRay);
+    DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
+    DIAGNOSTICS_STAT(DiagnosticsType::SHADOW_RAYS);
 
-            Ray refractionRay;
-            PerformRayRefraction(refractionRay, *inputRay, intersectionPoint, NdR, *outputIntersection, targetIOR);
-            outputIntersection->refractionIntersection->currentIOR = targetIOR;
-            Trace(&refractionRay, outputIntersection->refractionIntersection.get());
-        }
+    TraceMask traceMask;
+    const ObjectSpaceRay worldRay(*inputRay, &traceMask);
+    return acceleration->Occluded(nullptr, worldRay, inputRay);
+}
+
+bool Scene::Intersect(class Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    DIAGNOSTICS_STAT(DiagnosticsType::RAYS_CREATED);
+
+    TraceMask traceMask;
+    const ObjectSpaceRay worldRay(*inputRay, &traceMask);
+    return acceleration->Trace(nullptr, worldRay, inputRay, outputIntersection);
+}
+
+void Scene::PushSecondaryRays(const Ray& inputRay, IntersectionState& state, std::vector<SecondaryRay>& pendingRays) const
+{
+    const MeshObject* intersectedMesh = state.intersectedPrimitive->GetParentMeshObject();
+    assert(intersectedMesh);
+    const Material* currentMaterial = intersectedMesh->GetMaterial();
+    assert(currentMaterial);
+
+    const bool reflect = currentMaterial->IsReflective() && state.remainingReflectionBounces > 0;
+    const bool refract = currentMaterial->IsTransmissive() && state.remainingRefractionBounces > 0;
+    if (!reflect && !refract) 
+	{
+        return;
+    }
+
+    const glm::vec3 intersectionPoint = state.intersectionRay.GetRayPosition(state.intersectionT);
+    const float NdR = glm::dot(inputRay.GetRayDirection(), state.ComputeNormal());
+
+    // Refraction goes on the stack first so that the reflection branch is traced first, as the recursive version did.
+    float throughput = state.pathThroughput * currentMaterial->GetTransmittance();
+    float weight;
+    if (refract && SurvivesRoulette(throughput, weight)) 
+	{
+        IntersectionState* refractionIntersection = state.CreateRefractionIntersection(state.remainingReflectionBounces, state.remainingRefractionBounces - 1);
+
+        // If we're going into the mesh, set the target IOR to be the IOR of the mesh.
+        float targetIOR = (NdR < SMALL_EPSILON) ? currentMaterial->GetIOR() : 1.f;
+
+        SecondaryRay secondary;
+        PerformRayRefraction(secondary.ray, inputRay, intersectionPoint, NdR, state, targetIOR);
+        refractionIntersection->currentIOR = targetIOR;
+        refractionIntersection->pathThroughput = throughput;
+        refractionIntersection->rouletteWeight = weight;
+        secondary.state = refractionIntersection;
+        pendingRays.push_back(secondary);
+    }
+
+    throughput = state.pathThroughput * currentMaterial->GetReflectivity();
+    if (reflect && SurvivesRoulette(throughput, weight)) 
+	{
+        IntersectionState* reflectionIntersection = state.CreateReflectionIntersection(state.remainingReflectionBounces - 1, state.remainingRefractionBounces);
+
+        SecondaryRay secondary;
+        PerformRaySpecularReflection(secondary.ray, inputRay, intersectionPoint, NdR, state);
+        reflectionIntersection->pathThroughput = throughput;
+        reflectionIntersection->rouletteWeight = weight;
+        secondary.state = reflectionIntersection;
+        pendingRays.push_back(secondary);
+    }
+}
+
+bool Scene::SurvivesRoulette(float& throughput, float& weight) const
+{
+    weight = 1.f;
+    if (throughput >= minimumRayThroughput) 
+	{
+        return true;
+    }
+
+    // Keep the branch with probability throughput / minimum and boost the survivors so the estimate stays unbiased.
+    const float survivalProbability = throughput / minimumRayThroughput;
+    if (RandomGenerator::GetThreadGenerator().NextFloat() >= survivalProbability) 
+	{
+        return false;
     }
+    weight = 1.f / survivalProbability;
+    throughput = minimumRayThroughput;
+    return true;
+}
 
-    return didIntersect;
+void Scene::SetMinimumRayThroughput(float throughput)
+{
+    minimumRayThroughput = std::max(throughput, 0.f);
 }
 
 void Scene::PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const
@@ -103,9 +195,17 @@ void Scene::AddLight(std::shared_ptr<Light> light)
     sceneLights.emplace_back(std::move(light));
 }
 
+void Scene::SetMeshStorageMode(MeshStorageModes mode)
+{
+    for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        sceneObjects[i]->SetMeshStorageMode(mode);
+    }
+}
+
 void Scene::Finalize()
 {
     for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        sceneObjects[i]->SetTraceIndex(static_cast<int>(i));
         sceneObjects[i]->Finalize();
     }
     assert(acceleration);
@@ -4,6 +4,7 @@
 #include "common/Intersection/IntersectionState.h"
 
 enum class AccelerationTypes;
+enum class MeshStorageModes;
 class Light;
 class SceneObject;
 
@@ -16,8 +17,20 @@ public:
     // if outputIntersection is NULL, this merely checks whether or not the inputRay hits something.
     // if outputIntersection is NOT NULL, then this will check whether or not the inputRay hits something,
     //      and if it does, it will store that information and perform reflection/refraction and keep going.
+    //      Secondary rays are traced from an explicit stack; shading reads the resulting tree afterwards.
     bool Trace(class Ray* inputRay, IntersectionState* outputIntersection) const;
 
+    // Shadow-ray query: true if anything lies between the ray's min and max T. Stops at the first hit found.
+    bool Occluded(class Ray* inputRay) const;
+
+    // Reflection/refraction branches whose path throughput falls below this are played with Russian roulette.
+    // 0 traces every branch up to the bounce limits.
+    void SetMinimumRayThroughput(float throughput);
+    float GetMinimumRayThroughput() const
+    {
+        return minimumRayThroughput;
+    }
+
     size_t GetTotalObjects() const
     {
         return sceneObjects.size();
@@ -48,12 +61,20 @@ public:
     void AddSceneObject(std::shared_ptr<SceneObject> object);
     void AddLight(std::shared_ptr<Light> light);
 
+    void SetMeshStorageMode(MeshStorageModes mode);
     void Finalize();
 
     void PerformRaySpecularReflection(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state) const;
     void PerformRayRefraction(Ray& outputRay, const Ray& inputRay, const glm::vec3& intersectionPoint, const float NdR, const IntersectionState& state, float& targetIOR) const;
 private:
+    struct SecondaryRay;
+
+    bool Intersect(class Ray* inputRay, IntersectionState* outputIntersection) const;
+    void PushSecondaryRays(const Ray& inputRay, IntersectionState& state, std::vector<SecondaryRay>& pendingRays) const;
+    bool SurvivesRoulette(float& throughput, float& weight) const;
+
     std::shared_ptr<class AccelerationStructure> acceleration;
+    float minimumRayThroughput = 0.f;
 
     std::vector<std::shared_ptr<SceneObject>> sceneObjects;
     std::vector<std::shared_ptr<Light>> sceneLights;
@@ -1,12 +1,14 @@
 #include "common/Scene/SceneObject.h"
 #include "common/Scene/Geometry/Mesh/MeshObject.h"
 #include "common/Scene/Geometry/Ray/Ray.h"
+#include "common/Scene/Geometry/Ray/ObjectSpaceRay.h"
+#include "common/Scene/Geometry/Ray/TraceMask.h"
 #include "common/Intersection/IntersectionState.h"
 
 const float SceneObject::MINIMUM_SCALE = 0.01f;
 
 SceneObject::SceneObject():
-    worldToObjectMatrix(1.f), objectToWorldMatrix(1.f), position(0.f, 0.f, 0.f, 1.f), rotation(1.f, 0.f, 0.f, 0.f), scale(1.f), nameSet(false)
+    worldToObjectMatrix(1.f), objectToWorldMatrix(1.f), position(0.f, 0.f, 0.f, 1.f), rotation(1.f, 0.f, 0.f, 0.f), scale(1.f), traceIndex(-1), nameSet(false)
 {
 }
 
@@ -143,6 +145,13 @@ void SceneObject::ConfigureChildMeshAccelerationStructure(std::function<void(cla
     }
 }
 
+void SceneObject::SetMeshStorageMode(MeshStorageModes mode)
+{
+    for (size_t i = 0; i < childObjects.size(); ++i) {
+        childObjects[i]->SetStorageMode(mode);
+    }
+}
+
 void SceneObject::Finalize()
 {
     boundingBox.Reset();
@@ -156,14 +165,33 @@ void SceneObject::Finalize()
     acceleration->Initialize(childObjects);
 }
 
-bool SceneObject::Trace(const SceneObject* parentObject, Ray* inputRay, IntersectionState* outputIntersection) const
+bool SceneObject::Trace(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay, IntersectionState* outputIntersection) const
+{
+    if (localRay.traceMask && localRay.traceMask->IsMasked(traceIndex)) {
+        return false;
+    }
+    // Everything below this object lives in its object space, so transform the ray once here for the whole traversal.
+    const ObjectSpaceRay objectRay(GetWorldToObjectMatrix(), *inputRay);
+    bool hit = acceleration->Trace(this, objectRay, inputRay, outputIntersection);
+    if (!hit) {
+        if (localRay.traceMask) {
+            localRay.traceMask->SetMasked(traceIndex);
+        }
+    }
+    return hit;
+}
+
+bool SceneObject::Occluded(const SceneObject* parentObject, const ObjectSpaceRay& localRay, Ray* inputRay) const
 {
-    if (inputRay->IsObjectMasked(GetUniqueId())) {
+    if (localRay.traceMask && localRay.traceMask->IsMasked(traceIndex)) {
         return false;
     }
-    bool hit = acceleration->Trace(this, inputRay, outputIntersection);
+    const ObjectSpaceRay objectRay(GetWorldToObjectMatrix(), *inputRay);
+    bool hit = acceleration->Occluded(this, objectRay, inputRay);
     if (!hit) {
-        inputRay->SetRayMask(GetUniqueId());
+        if (localRay.traceMask) {
+            localRay.traceMask->SetMasked(traceIndex);
+        }
     }
     return hit;
 }
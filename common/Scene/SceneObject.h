@@ -2,6 +2,7 @@
 
 #include "common/common.h"
 #include "common/Acceleration/AccelerationCommon.h"
+#include "common/Scene/Geometry/Mesh/MeshStorageModes.h"
 
 class SceneObject : public std::enable_shared_from_this<SceneObject>, public AccelerationNode
 {
@@ -39,6 +40,7 @@ public:
     virtual void AddMeshObject(const std::vector<std::shared_ptr<MeshObject>>& objects);
     virtual int GetTotalMeshObjects() const { return static_cast<int>(childObjects.size()); }
     virtual const class MeshObject* GetMeshObject(int index) const;
+    virtual void SetMeshStorageMode(MeshStorageModes mode);
     virtual void Finalize();
 
     virtual void CreateDefaultAccelerationData();
@@ -53,11 +55,16 @@ public:
         return boundingBox;
     }
 
-    virtual bool Trace(const SceneObject* parentObject, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Trace(const SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay, struct IntersectionState* outputIntersection) const override;
+    virtual bool Occluded(const SceneObject* parentObject, const struct ObjectSpaceRay& localRay, class Ray* inputRay) const override;
 
     virtual std::string GetHumanIdentifier() const override;
     std::string GetChildObjectNames() const;
     void SetName(const std::string& input);
+
+    // Dense index of this object within its scene, used to key TraceMask. -1 until the scene is finalized.
+    void SetTraceIndex(int input) { traceIndex = input; }
+    int GetTraceIndex() const { return traceIndex; }
 protected:
     Box boundingBox;
     static const float MINIMUM_SCALE;
@@ -73,6 +80,8 @@ protected:
     class std::shared_ptr<class AccelerationStructure> acceleration;
     std::vector<std::shared_ptr<class MeshObject>> childObjects;
 
+    int traceIndex;
+
     bool nameSet;
     std::string objectName;
 };
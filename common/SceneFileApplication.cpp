@@ -0,0 +1,539 @@
+#include "common/SceneFileApplication.h"
+#include "common/core.h"
+#include "common/Sampling/PoissonDisks/PoissonDisksColorSampler.h"
+#include "common/Utility/Config/ConfigParsing.h"
+
+namespace
+{
+// Also catches include cycles that spell the same file differently.
+const size_t MAX_INCLUDE_DEPTH = 16;
+
+const char* const RENDERER_TYPES[] = { "backward", "photon", "progressive" };
+const char* const SAMPLER_TYPES[] = { "random", "jitter", "poisson_disks", "sobol", "halton", "blue_noise" };
+
+struct RendererSettingInfo
+{
+    const char* name;
+    bool isInteger;
+    // The only renderer type that reads the setting; the others warn that it is ignored.
+    const char* rendererType;
+};
+
+const RendererSettingInfo RENDERER_SETTINGS[] = {
+    { "diffuse_photons", true, "photon" },
+    { "caustic_photons", true, "photon" },
+    { "gather_samples", true, "photon" },
+    { "irradiance_cache_accuracy", false, "photon" },
+    { "radiance_photon_spacing", true, "photon" },
+    { "photons_per_pass", true, "progressive" },
+    { "max_passes", true, "progressive" },
+    { "time_budget", false, "progressive" },
+    { "initial_radius", false, "progressive" },
+    { "radius_reduction", false, "progressive" },
+    { "photon_power_scale", false, "progressive" }
+};
+
+template<size_t N>
+bool IsOneOf(const std::string& text, const char* const (&names)[N])
+{
+    return std::find(std::begin(names), std::end(names), text) != std::end(names);
+}
+
+bool IsTransformProperty(const std::string& keyword)
+{
+    return keyword == "position" || keyword == "translate" || keyword == "rotate" || keyword == "scale";
+}
+
+const RendererSettingInfo* FindRendererSetting(const std::string& name)
+{
+    for (const RendererSettingInfo& info : RENDERER_SETTINGS) {
+        if (name == info.name) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+bool IsAbsolutePath(const std::string& path)
+{
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+// Paths in an include are relative to the including file.
+std::string ResolveRelativePath(const std::string& fromFile, const std::string& path)
+{
+    if (path.empty() || IsAbsolutePath(path)) {
+        return path;
+    }
+    const size_t separator = fromFile.find_last_of("/\\");
+    return (separator == std::string::npos) ? path : fromFile.substr(0, separator + 1) + path;
+}
+
+// MeshLoader reads meshes from the assets directory, so a mesh path has to stay inside it and name an existing file.
+bool CheckMeshPath(const std::string& path, std::string& error)
+{
+    const std::string assetDirectory = STRINGIFY(ASSET_PATH);
+    std::vector<std::string> components;
+    size_t start = 0;
+    for (size_t end = 0; end <= path.size(); ++end) {
+        if (end == path.size() || path[end] == '/' || path[end] == '\\') {
+            components.push_back(path.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    if (IsAbsolutePath(path) || std::find(components.begin(), components.end(), "..") != components.end()) {
+        error = "mesh file " + path + " is not inside the assets directory " + assetDirectory;
+        return false;
+    }
+    if (!std::ifstream(assetDirectory + "/" + path)) {
+        error = "mesh file " + path + " does not exist in the assets directory " + assetDirectory;
+        return false;
+    }
+    return true;
+}
+}
+
+SceneFileApplication::SceneFileApplication() :
+    rendererType("backward"), samplerType("jitter"), adaptiveError(0.05f), poissonRadius(0.1f)
+{
+    camera.fov = 45.f;
+    camera.zNear = 0.f;
+    camera.zFar = std::numeric_limits<float>::max();
+}
+
+bool SceneFileApplication::LoadSceneFile(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file) {
+        std::cerr << "ERROR: Could not open the scene file " << fileName << std::endl;
+        return false;
+    }
+
+    openSceneFiles.push_back(fileName);
+    bool success = true;
+    BlockType block = BlockType::NONE;
+    std::vector<std::string> tokens;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        std::string error;
+        if (!ConfigParsing::Tokenize(line, tokens)) {
+            error = "unterminated quote";
+        } else if (!tokens.empty()) {
+            ParseDirective(tokens, fileName, block, error);
+        }
+
+        if (!error.empty()) {
+            std::cerr << "ERROR: " << fileName << ":" << lineNumber << ": " << error << std::endl;
+            success = false;
+        }
+    }
+    openSceneFiles.pop_back();
+    return success;
+}
+
+bool SceneFileApplication::ParseDirective(const std::vector<std::string>& tokens, const std::string& fileName, BlockType& block, std::string& error)
+{
+    const std::string& keyword = tokens[0];
+    if (keyword == "set") {
+        if (tokens.size() < 3) {
+            error = "expected 'set <name> <value>'";
+        } else if (!ApplySetting(tokens[1], ConfigParsing::JoinTokens(tokens, 2))) {
+            error = "invalid setting '" + tokens[1] + "' = '" + ConfigParsing::JoinTokens(tokens, 2) + "'";
+        }
+    } else if (keyword == "include") {
+        if (tokens.size() != 2) {
+            error = "expected 'include <file>'";
+        } else {
+            const std::string includeFile = ResolveRelativePath(fileName, tokens[1]);
+            if (std::find(openSceneFiles.begin(), openSceneFiles.end(), includeFile) != openSceneFiles.end()) {
+                error = tokens[1] + " includes itself";
+            } else if (openSceneFiles.size() >= MAX_INCLUDE_DEPTH) {
+                error = "includes are nested too deeply";
+            } else if (!LoadSceneFile(includeFile)) {
+                error = "failed to include " + tokens[1];
+            }
+        }
+        block = BlockType::NONE;
+    } else if (keyword == "camera") {
+        block = BlockType::CAMERA;
+        camera.transforms.clear();
+        if (tokens.size() > 2 || (tokens.size() == 2 && !ConfigParsing::ParseFloat(tokens[1], camera.fov))) {
+            error = "expected 'camera [fov]'";
+        }
+    } else if (keyword == "mesh") {
+        block = BlockType::MESH;
+        if (tokens.size() != 2) {
+            error = "expected 'mesh <file>'";
+            block = BlockType::NONE;
+        } else {
+            // The block is still read, so a missing file does not also report every line that follows it.
+            CheckMeshPath(tokens[1], error);
+            meshes.push_back(MeshDescription());
+            meshes.back().fileName = tokens[1];
+        }
+    } else if (keyword == "light") {
+        block = BlockType::LIGHT;
+        LightDescription light;
+        light.type = (tokens.size() > 1) ? tokens[1] : "";
+        light.color = glm::vec3(1.f);
+        light.areaSampleGrid = glm::ivec2(2, 2);
+        const bool isArea = (light.type == "area");
+        if ((light.type == "point" || light.type == "directional") && tokens.size() == 2) {
+            lights.push_back(light);
+        } else if (isArea && tokens.size() == 3 && ConfigParsing::ParseVec2(tokens[2], light.areaSize)) {
+            lights.push_back(light);
+        } else if (isArea && tokens.size() == 4 && ConfigParsing::ParseVec2(tokens[2] + " " + tokens[3], light.areaSize)) {
+            lights.push_back(light);
+        } else {
+            error = "expected 'light point', 'light directional' or 'light area <width> <height>'";
+            block = BlockType::NONE;
+        }
+    } else if (block == BlockType::CAMERA) {
+        if (keyword == "fov" || keyword == "znear" || keyword == "zfar") {
+            float& value = (keyword == "fov") ? camera.fov : ((keyword == "znear") ? camera.zNear : camera.zFar);
+            if (tokens.size() != 2 || !ConfigParsing::ParseFloat(tokens[1], value)) {
+                error = "expected '" + keyword + " <value>'";
+            }
+        } else {
+            ParseTransform(tokens, camera.transforms, error);
+        }
+    } else if (block == BlockType::MESH) {
+        if (IsTransformProperty(keyword)) {
+            ParseTransform(tokens, meshes.back().transforms, error);
+        } else {
+            ParseMaterialProperty(tokens, error);
+        }
+    } else if (block == BlockType::LIGHT) {
+        LightDescription& light = lights.back();
+        if (keyword == "color") {
+            if (!ConfigParsing::ParseVec3(ConfigParsing::JoinTokens(tokens, 1), light.color)) {
+                error = "expected 'color <r> <g> <b>'";
+            }
+        } else if (keyword == "samples" && light.type == "area") {
+            if (!ConfigParsing::ParseIVec2(ConfigParsing::JoinTokens(tokens, 1), light.areaSampleGrid) || glm::any(glm::lessThan(light.areaSampleGrid, glm::ivec2(1)))) {
+                error = "expected 'samples <x> <y>'";
+            }
+        } else {
+            ParseTransform(tokens, light.transforms, error);
+        }
+    } else {
+        error = "unknown directive '" + keyword + "'";
+    }
+    return error.empty();
+}
+
+// position, translate, rotate or scale; anything else is reported as an unknown property.
+bool SceneFileApplication::ParseTransform(const std::vector<std::string>& tokens, std::vector<TransformStep>& output, std::string& error) const
+{
+    const std::string& keyword = tokens[0];
+    const std::string values = ConfigParsing::JoinTokens(tokens, 1);
+    TransformStep step;
+    bool parsed;
+    if (keyword == "position" || keyword == "translate") {
+        step.type = (keyword == "position") ? TransformStep::Type::POSITION : TransformStep::Type::TRANSLATE;
+        glm::vec3 offset;
+        parsed = ConfigParsing::ParseVec3(values, offset);
+        step.values = glm::vec4(offset, 0.f);
+    } else if (keyword == "rotate") {
+        step.type = TransformStep::Type::ROTATE;
+        parsed = ConfigParsing::ParseVec4(values, step.values) && glm::length(glm::vec3(step.values)) > 0.f;
+    } else if (keyword == "scale") {
+        step.type = TransformStep::Type::SCALE;
+        parsed = ConfigParsing::ParseFloat(values, step.values.x);
+    } else {
+        error = "unknown property '" + keyword + "'";
+        return false;
+    }
+
+    if (!parsed) {
+        error = "invalid values for '" + keyword + "'";
+        return false;
+    }
+    output.push_back(step);
+    return true;
+}
+
+bool SceneFileApplication::ParseMaterialProperty(const std::vector<std::string>& tokens, std::string& error)
+{
+    // [part <index>] <property> <values>
+    MaterialProperty property;
+    property.part = -1;
+    size_t first = 0;
+    if (tokens[0] == "part") {
+        if (tokens.size() < 3 || !ConfigParsing::ParseInt(tokens[1], property.part) || property.part < 0) {
+            error = "expected 'part <index> <property> <values>'";
+            return false;
+        }
+        first = 2;
+    }
+
+    property.name = tokens[first];
+    const std::string values = ConfigParsing::JoinTokens(tokens, first + 1);
+    glm::vec3 color;
+    bool parsed;
+    if (property.name == "diffuse" || property.name == "ambient") {
+        parsed = ConfigParsing::ParseVec3(values, color);
+        property.values = glm::vec4(color, 0.f);
+    } else if (property.name == "specular") {
+        // Color and shininess.
+        parsed = ConfigParsing::ParseVec4(values, property.values);
+    } else if (property.name == "reflectivity" || property.name == "transmittance" || property.name == "ior") {
+        parsed = ConfigParsing::ParseFloat(values, property.values.x);
+    } else {
+        error = "unknown material property '" + property.name + "'";
+        return false;
+    }
+
+    if (!parsed) {
+        error = "invalid values for '" + property.name + "'";
+        return false;
+    }
+    meshes.back().materialProperties.push_back(property);
+    return true;
+}
+
+void SceneFileApplication::ApplyTransforms(const std::vector<TransformStep>& transforms, SceneObject& object)
+{
+    for (const TransformStep& step : transforms) {
+        switch (step.type) {
+        case TransformStep::Type::POSITION:
+            object.SetPosition(glm::vec3(step.values));
+            break;
+        case TransformStep::Type::TRANSLATE:
+            object.Translate(glm::vec3(step.values));
+            break;
+        case TransformStep::Type::ROTATE:
+            object.Rotate(glm::normalize(glm::vec3(step.values)), step.values.w * PI / 180.f);
+            break;
+        case TransformStep::Type::SCALE:
+            object.MultScale(step.values.x);
+            break;
+        }
+    }
+}
+
+bool SceneFileApplication::ApplySetting(const std::string& name, const std::string& value)
+{
+    if (name == "renderer") {
+        if (!IsOneOf(value, RENDERER_TYPES)) {
+            return false;
+        }
+        rendererType = value;
+    } else if (name == "sampler") {
+        if (!IsOneOf(value, SAMPLER_TYPES)) {
+            return false;
+        }
+        samplerType = value;
+    } else if (name == "adaptive_error") {
+        float error;
+        if (!ConfigParsing::ParseFloat(value, error) || error < 0.f) {
+            return false;
+        }
+        adaptiveError = error;
+    } else if (name == "poisson_radius") {
+        float radius;
+        if (!ConfigParsing::ParseFloat(value, radius) || radius <= 0.f) {
+            return false;
+        }
+        poissonRadius = radius;
+    } else if (const RendererSettingInfo* info = FindRendererSetting(name)) {
+        RendererSetting setting;
+        setting.name = name;
+        setting.integerValue = 0;
+        setting.floatValue = 0.f;
+        if (info->isInteger) {
+            if (!ConfigParsing::ParseInt(value, setting.integerValue) || setting.integerValue < 0) {
+                return false;
+            }
+        } else if (!ConfigParsing::ParseFloat(value, setting.floatValue) || setting.floatValue < 0.f) {
+            return false;
+        }
+        rendererSettings.push_back(setting);
+    } else {
+        return Application::ApplySetting(name, value);
+    }
+    return true;
+}
+
+std::shared_ptr<Camera> SceneFileApplication::CreateCamera() const
+{
+    const glm::vec2 resolution = GetImageOutputResolution();
+    std::shared_ptr<PerspectiveCamera> newCamera = std::make_shared<PerspectiveCamera>(resolution.x / resolution.y, camera.fov);
+    newCamera->SetZNear(camera.zNear);
+    newCamera->SetZFar(camera.zFar);
+    ApplyTransforms(camera.transforms, *newCamera);
+    return newCamera;
+}
+
+std::shared_ptr<Scene> SceneFileApplication::CreateScene() const
+{
+    std::shared_ptr<Scene> newScene = std::make_shared<Scene>();
+    const AccelerationTypes accelerationType = GetAcceleratingStructureType();
+
+    // Same starting material as the assignments; the mesh file's own materials and then the scene file override it.
+    std::shared_ptr<BlinnPhongMaterial> baseMaterial = std::make_shared<BlinnPhongMaterial>();
+    baseMaterial->SetDiffuse(glm::vec3(1.f, 1.f, 1.f));
+    baseMaterial->SetSpecular(glm::vec3(0.6f, 0.6f, 0.6f), 40.f);
+
+    for (const MeshDescription& mesh : meshes) {
+        std::vector<std::shared_ptr<aiMaterial>> loadedMaterials;
+        std::vector<std::shared_ptr<MeshObject>> meshObjects = MeshLoader::LoadMesh(mesh.fileName, &loadedMaterials);
+        if (meshObjects.empty()) {
+            // Rendering the scene without one of its meshes would only produce a wrong image.
+            std::cerr << "ERROR: Nothing was loaded from " << mesh.fileName << "." << std::endl;
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < meshObjects.size(); ++i) {
+            std::shared_ptr<Material> materialCopy = baseMaterial->Clone();
+            materialCopy->LoadMaterialFromAssimp(loadedMaterials[i]);
+            BlinnPhongMaterial* blinnPhong = static_cast<BlinnPhongMaterial*>(materialCopy.get());
+            for (const MaterialProperty& property : mesh.materialProperties) {
+                if (property.part >= 0 && static_cast<size_t>(property.part) != i) {
+                    continue;
+                }
+
+                if (property.name == "diffuse") {
+                    blinnPhong->SetDiffuse(glm::vec3(property.values));
+                } else if (property.name == "specular") {
+                    blinnPhong->SetSpecular(glm::vec3(property.values), property.values.w);
+                } else if (property.name == "ambient") {
+                    materialCopy->SetAmbient(glm::vec3(property.values));
+                } else if (property.name == "reflectivity") {
+                    materialCopy->SetReflectivity(property.values.x);
+                } else if (property.name == "transmittance") {
+                    materialCopy->SetTransmittance(property.values.x);
+                } else if (property.name == "ior") {
+                    materialCopy->SetIOR(property.values.x);
+                }
+            }
+            meshObjects[i]->SetMaterial(materialCopy);
+        }
+
+        for (const MaterialProperty& property : mesh.materialProperties) {
+            if (property.part >= static_cast<int>(meshObjects.size())) {
+                std::cerr << "WARNING: " << mesh.fileName << " has no part " << property.part << "." << std::endl;
+            }
+        }
+
+        std::shared_ptr<SceneObject> sceneObject = std::make_shared<SceneObject>();
+        sceneObject->AddMeshObject(meshObjects);
+        ApplyTransforms(mesh.transforms, *sceneObject);
+        sceneObject->CreateAccelerationData(accelerationType);
+        newScene->AddSceneObject(sceneObject);
+    }
+
+    for (const LightDescription& light : lights) {
+        std::shared_ptr<Light> newLight;
+        if (light.type == "point") {
+            newLight = std::make_shared<PointLight>();
+        } else if (light.type == "directional") {
+            newLight = std::make_shared<DirectionalLight>();
+        } else {
+            std::shared_ptr<AreaLight> areaLight = std::make_shared<AreaLight>(light.areaSize);
+            areaLight->SetSamplerAttributes(glm::ivec3(light.areaSampleGrid, 1), light.areaSampleGrid.x * light.areaSampleGrid.y);
+            newLight = areaLight;
+        }
+        newLight->SetLightColor(light.color);
+        ApplyTransforms(light.transforms, *newLight);
+        newScene->AddLight(newLight);
+    }
+
+    newScene->GenerateAccelerationData(accelerationType);
+    return newScene;
+}
+
+std::shared_ptr<ColorSampler> SceneFileApplication::CreateSampler() const
+{
+    const std::string type = GetUsePoissonDisksSampler() ? "poisson_disks" : samplerType;
+    std::shared_ptr<ColorSampler> sampler;
+    if (type == "jitter") {
+        std::shared_ptr<JitterColorSampler> jitter = std::make_shared<JitterColorSampler>();
+        jitter->SetGridSize(GetGridSize());
+        sampler = jitter;
+    } else if (type == "poisson_disks") {
+        std::shared_ptr<PoissonDisksColorSampler> poissonDisks = std::make_shared<PoissonDisksColorSampler>();
+        poissonDisks->SetRadius(poissonRadius);
+        sampler = poissonDisks;
+    } else if (type == "sobol") {
+        sampler = std::make_shared<SobolColorSampler>();
+    } else if (type == "halton") {
+        sampler = std::make_shared<HaltonColorSampler>();
+    } else if (type == "blue_noise") {
+        sampler = std::make_shared<BlueNoiseColorSampler>();
+    } else {
+        sampler = std::make_shared<ColorSampler>();
+    }
+
+    if (!GetUseAdaptiveSampler()) {
+        return sampler;
+    }
+    std::shared_ptr<VarianceAdaptiveSampler> adaptive = std::make_shared<VarianceAdaptiveSampler>();
+    adaptive->SetInternalSampler(sampler);
+    adaptive->SetErrorParameters(adaptiveError, GetMinSamplesPerPixel());
+    return adaptive;
+}
+
+std::shared_ptr<Renderer> SceneFileApplication::CreateRenderer(std::shared_ptr<Scene> scene, std::shared_ptr<ColorSampler> sampler) const
+{
+    for (const RendererSetting& setting : rendererSettings) {
+        const RendererSettingInfo* info = FindRendererSetting(setting.name);
+        assert(info);
+        if (rendererType != info->rendererType) {
+            std::cerr << "WARNING: " << setting.name << " only applies to the " << info->rendererType << " renderer and is ignored by the " << rendererType << " renderer." << std::endl;
+        }
+    }
+
+    if (rendererType == "backward") {
+        return std::make_shared<BackwardRenderer>(scene, sampler);
+    }
+
+    std::shared_ptr<PhotonMappingRenderer> renderer;
+    std::shared_ptr<ProgressivePhotonMappingRenderer> progressive;
+    if (rendererType == "progressive") {
+        progressive = std::make_shared<ProgressivePhotonMappingRenderer>(scene, sampler);
+        renderer = progressive;
+    } else {
+        renderer = std::make_shared<PhotonMappingRenderer>(scene, sampler);
+    }
+    renderer->SetNumberOfPhotonThreads(GetNumThreads());
+
+    for (const RendererSetting& setting : rendererSettings) {
+        if (rendererType != FindRendererSetting(setting.name)->rendererType) {
+            continue;
+        }
+
+        const int integerValue = setting.integerValue;
+        const float floatValue = setting.floatValue;
+        if (setting.name == "diffuse_photons") {
+            renderer->SetNumberOfDiffusePhotons(integerValue);
+        } else if (setting.name == "caustic_photons") {
+            renderer->SetNumberOfCausticPhotons(integerValue);
+        } else if (setting.name == "gather_samples") {
+            renderer->SetNumberOfGatherSamples(integerValue);
+        } else if (setting.name == "irradiance_cache_accuracy") {
+            renderer->SetIrradianceCacheAccuracy(floatValue);
+        } else if (setting.name == "radiance_photon_spacing") {
+            renderer->SetRadiancePhotonSpacing(integerValue);
+        } else if (setting.name == "photons_per_pass") {
+            progressive->SetPhotonsPerPass(integerValue);
+        } else if (setting.name == "max_passes") {
+            progressive->SetMaxPasses(integerValue);
+        } else if (setting.name == "time_budget") {
+            progressive->SetTimeBudget(floatValue);
+        } else if (setting.name == "initial_radius") {
+            progressive->SetInitialRadius(floatValue);
+        } else if (setting.name == "radius_reduction") {
+            progressive->SetRadiusReduction(floatValue);
+        } else if (setting.name == "photon_power_scale") {
+            progressive->SetPhotonPowerScale(floatValue);
+        }
+    }
+    return renderer;
+}
+
+bool SceneFileApplication::NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex)
+{
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "common/Application.h"
+
+// Application whose camera, meshes, materials, lights, sampler and renderer are read from a scene file at runtime,
+// so changing a render does not need a rebuild. The format is described in README.md. Settings in the file go
+// through ApplySetting as they are read; anything applied afterwards (e.g. from the command line) overrides them.
+class SceneFileApplication : public Application
+{
+public:
+    SceneFileApplication();
+
+    // Reports every problem on stderr with its file and line, and returns false if there was any.
+    bool LoadSceneFile(const std::string& fileName);
+
+    // Adds renderer, sampler, adaptive_error, poisson_radius and the photon mapping settings to Application's.
+    virtual bool ApplySetting(const std::string& name, const std::string& value) override;
+
+    virtual std::shared_ptr<class Camera> CreateCamera() const override;
+    virtual std::shared_ptr<class Scene> CreateScene() const override;
+    virtual std::shared_ptr<class ColorSampler> CreateSampler() const override;
+    virtual std::shared_ptr<class Renderer> CreateRenderer(std::shared_ptr<class Scene> scene, std::shared_ptr<class ColorSampler> sampler) const override;
+    virtual bool NotifyNewPixelSample(glm::vec3 inputSampleColor, int sampleIndex) override;
+
+private:
+    enum class BlockType
+    {
+        NONE,
+        CAMERA,
+        MESH,
+        LIGHT
+    };
+
+    // Applied to the object in the order they were written.
+    struct TransformStep
+    {
+        enum class Type
+        {
+            POSITION,
+            TRANSLATE,
+            ROTATE,     // Axis and angle in degrees.
+            SCALE
+        };
+
+        Type type;
+        glm::vec4 values;
+    };
+
+    struct CameraDescription
+    {
+        float fov;
+        float zNear;
+        float zFar;
+        std::vector<TransformStep> transforms;
+    };
+
+    // Overrides a property of the Blinn-Phong material loaded for one part of a mesh file, or for every part.
+    struct MaterialProperty
+    {
+        int part;   // -1 for every part.
+        std::string name;
+        glm::vec4 values;
+    };
+
+    struct MeshDescription
+    {
+        std::string fileName;
+        std::vector<MaterialProperty> materialProperties;
+        std::vector<TransformStep> transforms;
+    };
+
+    struct LightDescription
+    {
+        std::string type;
+        glm::vec3 color;
+        glm::vec2 areaSize;
+        glm::ivec2 areaSampleGrid;
+        std::vector<TransformStep> transforms;
+    };
+
+    // Integer settings (photon counts, passes) live in integerValue, the others in floatValue, so large counts are
+    // not rounded through a float.
+    struct RendererSetting
+    {
+        std::string name;
+        int integerValue;
+        float floatValue;
+    };
+
+    bool ParseDirective(const std::vector<std::string>& tokens, const std::string& fileName, BlockType& block, std::string& error);
+    bool ParseTransform(const std::vector<std::string>& tokens, std::vector<TransformStep>& output, std::string& error) const;
+    bool ParseMaterialProperty(const std::vector<std::string>& tokens, std::string& error);
+    static void ApplyTransforms(const std::vector<TransformStep>& transforms, class SceneObject& object);
+
+    CameraDescription camera;
+    std::vector<MeshDescription> meshes;
+    std::vector<LightDescription> lights;
+
+    std::string rendererType;
+    std::vector<RendererSetting> rendererSettings;
+    std::string samplerType;
+    float adaptiveError;
+    float poissonRadius;
+
+    // Files being read, innermost last.
+    std::vector<std::string> openSceneFiles;
+};
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "common/Scheduling/TileScheduler.h"
+
+TileScheduler::TileScheduler(const glm::ivec2& resolution, const glm::ivec2& inputTileSize, std::vector<int> tileOrder):
+    imageResolution(resolution), tileSize(glm::max(inputTileSize, glm::ivec2(1))), scheduledTiles(std::move(tileOrder)), nextTile(0)
+{
+    tileCount = (imageResolution + tileSize - 1) / tileSize;
+    totalTiles = tileCount.x * tileCount.y;
+    tileTimes.resize(totalTiles, 0.0);
+    tileThreads.resize(totalTiles, -1);
+}
+
+bool TileScheduler::AcquireTile(RenderTile& output)
+{
+    const int next = nextTile.fetch_add(1, std::memory_order_relaxed);
+    if (scheduledTiles.empty()) {
+        if (next >= totalTiles) {
+            return false;
+        }
+        output = GetTile(next);
+        return true;
+    }
+
+    if (next >= static_cast<int>(scheduledTiles.size())) {
+        return false;
+    }
+    output = GetTile(scheduledTiles[next]);
+    return true;
+}
+
+RenderTile TileScheduler::GetTile(int index) const
+{
+    assert(index >= 0 && index < totalTiles);
+    const glm::ivec2 tileCoordinate(index % tileCount.x, index / tileCount.x);
+
+    RenderTile tile;
+    tile.index = index;
+    tile.minPixel = tileCoordinate * tileSize;
+    tile.maxPixel = glm::min(tile.minPixel + tileSize, imageResolution);
+    return tile;
+}
+
+void TileScheduler::RecordTileTime(const RenderTile& tile, int threadIndex, double seconds)
+{
+    assert(tile.index >= 0 && tile.index < totalTiles);
+    tileTimes[tile.index] = seconds;
+    tileThreads[tile.index] = threadIndex;
+}
+
+void TileScheduler::PrintStatistics(std::ostream& output, bool includePerTileTimes) const
+{
+    if (!totalTiles) {
+        return;
+    }
+
+    double minTime = std::numeric_limits<double>::max();
+    double maxTime = 0.0;
+    double totalTime = 0.0;
+    int slowestTile = 0;
+    std::vector<double> threadTimes;
+    for (int i = 0; i < totalTiles; ++i) {
+        minTime = std::min(minTime, tileTimes[i]);
+        if (tileTimes[i] > maxTime) {
+            maxTime = tileTimes[i];
+            slowestTile = i;
+        }
+        totalTime += tileTimes[i];
+
+        if (tileThreads[i] >= static_cast<int>(threadTimes.size())) {
+            threadTimes.resize(tileThreads[i] + 1, 0.0);
+        }
+        if (tileThreads[i] >= 0) {
+            threadTimes[tileThreads[i]] += tileTimes[i];
+        }
+    }
+
+    output << "Tiles " << totalTiles << " (" << tileSize.x << "x" << tileSize.y << ")" << std::endl;
+    output << "Tile time min/avg/max " << minTime << " / " << totalTime / totalTiles << " / " << maxTime << " seconds" << std::endl;
+    output << "Slowest tile " << slowestTile << " at pixel " << (slowestTile % tileCount.x) * tileSize.x << ", " << (slowestTile / tileCount.x) * tileSize.y << std::endl;
+    for (size_t i = 0; i < threadTimes.size(); ++i) {
+        output << "Thread " << i << " busy " << threadTimes[i] << " seconds" << std::endl;
+    }
+
+    if (includePerTileTimes) {
+        for (int i = 0; i < totalTiles; ++i) {
+            output << "Tile " << i << " [" << (i % tileCount.x) * tileSize.x << ", " << (i / tileCount.x) * tileSize.y << "] thread " << tileThreads[i] << ": " << tileTimes[i] << " seconds" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common/common.h"
+#include <atomic>
+
+struct RenderTile
+{
+    int index;
+
+    // Pixel range covered by the tile -- min inclusive, max exclusive.
+    glm::ivec2 minPixel;
+    glm::ivec2 maxPixel;
+};
+
+// Splits the image into fixed size tiles and hands them out to render threads through a single atomic counter.
+// Threads that finish early simply grab the next tile, so expensive regions of the image (glass, caustics) no longer
+// stall the whole frame behind one thread. Tiles on the right/bottom border are clipped so every pixel is covered.
+class TileScheduler
+{
+public:
+    // A non-empty tileOrder restricts the scheduler to those tile indices, handed out in that order.
+    TileScheduler(const glm::ivec2& resolution, const glm::ivec2& inputTileSize, std::vector<int> tileOrder = std::vector<int>());
+
+    // Returns false once every tile has been handed out.
+    bool AcquireTile(RenderTile& output);
+
+    // Each tile is recorded by exactly one thread so no synchronization is necessary.
+    void RecordTileTime(const RenderTile& tile, int threadIndex, double seconds);
+
+    int GetTotalTiles() const { return totalTiles; }
+    RenderTile GetTile(int index) const;
+
+    void PrintStatistics(std::ostream& output, bool includePerTileTimes) const;
+private:
+    glm::ivec2 imageResolution;
+    glm::ivec2 tileSize;
+    glm::ivec2 tileCount;
+    int totalTiles;
+
+    std::vector<int> scheduledTiles;
+    std::atomic<int> nextTile;
+
+    std::vector<double> tileTimes;
+    std::vector<int> tileThreads;
+};
@@ -0,0 +1,162 @@
+#include "common/Utility/Config/ConfigParsing.h"
+#include "common/Acceleration/AccelerationTypes.h"
+#include <cctype>
+
+namespace
+{
+const char* const ACCELERATION_TYPE_NAMES[] = { "none", "uniform_grid", "bvh", "linear_bvh" };
+const char* const MESH_STORAGE_MODE_NAMES[] = { "primitives", "packed_triangles" };
+
+// Reads exactly count values from the text; anything left over is an error.
+template<typename T>
+bool ParseComponents(const std::string& text, T* output, int count)
+{
+    std::string spaced = text;
+    std::replace(spaced.begin(), spaced.end(), ',', ' ');
+    std::istringstream stream(spaced);
+    for (int i = 0; i < count; ++i) {
+        if (!(stream >> output[i])) {
+            return false;
+        }
+    }
+    stream >> std::ws;
+    return stream.eof();
+}
+
+template<typename Enum, size_t N>
+bool ParseName(const std::string& text, const char* const (&names)[N], Enum& output)
+{
+    for (size_t i = 0; i < N; ++i) {
+        if (text == names[i]) {
+            output = static_cast<Enum>(i);
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+namespace ConfigParsing
+{
+
+bool Tokenize(const std::string& line, std::vector<std::string>& output)
+{
+    output.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        if (std::isspace(static_cast<unsigned char>(line[i]))) {
+            ++i;
+        } else if (line[i] == '#') {
+            break;
+        } else if (line[i] == '"') {
+            const size_t end = line.find('"', i + 1);
+            if (end == std::string::npos) {
+                return false;
+            }
+            output.push_back(line.substr(i + 1, end - i - 1));
+            i = end + 1;
+        } else {
+            const size_t start = i;
+            while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i])) && line[i] != '#') {
+                ++i;
+            }
+            output.push_back(line.substr(start, i - start));
+        }
+    }
+    return true;
+}
+
+std::string JoinTokens(const std::vector<std::string>& tokens, size_t first)
+{
+    std::string result;
+    for (size_t i = first; i < tokens.size(); ++i) {
+        if (i > first) {
+            result += ' ';
+        }
+        result += tokens[i];
+    }
+    return result;
+}
+
+bool ParseInt(const std::string& text, int& output)
+{
+    return ParseComponents(text, &output, 1);
+}
+
+bool ParseUnsigned(const std::string& text, uint32_t& output)
+{
+    // istream happily wraps "-1" around, so go through a signed type first.
+    long long value;
+    if (!ParseComponents(text, &value, 1) || value < 0 || value > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    output = static_cast<uint32_t>(value);
+    return true;
+}
+
+bool ParseFloat(const std::string& text, float& output)
+{
+    return ParseComponents(text, &output, 1);
+}
+
+bool ParseBool(const std::string& text, bool& output)
+{
+    if (text == "on" || text == "true" || text == "yes" || text == "1") {
+        output = true;
+        return true;
+    }
+    if (text == "off" || text == "false" || text == "no" || text == "0") {
+        output = false;
+        return true;
+    }
+    return false;
+}
+
+bool ParseVec2(const std::string& text, glm::vec2& output)
+{
+    return ParseComponents(text, glm::value_ptr(output), 2);
+}
+
+bool ParseVec3(const std::string& text, glm::vec3& output)
+{
+    return ParseComponents(text, glm::value_ptr(output), 3);
+}
+
+bool ParseVec4(const std::string& text, glm::vec4& output)
+{
+    return ParseComponents(text, glm::value_ptr(output), 4);
+}
+
+bool ParseIVec2(const std::string& text, glm::ivec2& output)
+{
+    return ParseComponents(text, glm::value_ptr(output), 2);
+}
+
+bool ParseIVec3(const std::string& text, glm::ivec3& output)
+{
+    return ParseComponents(text, glm::value_ptr(output), 3);
+}
+
+bool ParseAccelerationType(const std::string& text, AccelerationTypes& output)
+{
+    return ParseName(text, ACCELERATION_TYPE_NAMES, output);
+}
+
+const char* GetAccelerationTypeName(AccelerationTypes type)
+{
+    const size_t index = static_cast<size_t>(type);
+    return index < sizeof(ACCELERATION_TYPE_NAMES) / sizeof(ACCELERATION_TYPE_NAMES[0]) ? ACCELERATION_TYPE_NAMES[index] : "unknown";
+}
+
+bool ParseMeshStorageMode(const std::string& text, MeshStorageModes& output)
+{
+    return ParseName(text, MESH_STORAGE_MODE_NAMES, output);
+}
+
+const char* GetMeshStorageModeName(MeshStorageModes mode)
+{
+    const size_t index = static_cast<size_t>(mode);
+    return index < sizeof(MESH_STORAGE_MODE_NAMES) / sizeof(MESH_STORAGE_MODE_NAMES[0]) ? MESH_STORAGE_MODE_NAMES[index] : "unknown";
+}
+
+}
\ No newline at end of file
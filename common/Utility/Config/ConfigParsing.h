@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common/common.h"
+#include "common/Scene/Geometry/Mesh/MeshStorageModes.h"
+
+enum class AccelerationTypes;
+
+// Text parsing shared by the scene file reader, Application::ApplySetting and the command line. Every parser
+// rejects trailing text, so "4x" is not read as 4. Vector components may be separated by spaces or commas.
+namespace ConfigParsing
+{
+
+// Splits a line on whitespace. Double quotes group a token ("New scene/out.png") and '#' starts a comment.
+// Returns false if a quote is left open.
+bool Tokenize(const std::string& line, std::vector<std::string>& output);
+std::string JoinTokens(const std::vector<std::string>& tokens, size_t first);
+
+bool ParseInt(const std::string& text, int& output);
+bool ParseUnsigned(const std::string& text, uint32_t& output);
+bool ParseFloat(const std::string& text, float& output);
+// Accepts on/off, true/false, yes/no and 1/0.
+bool ParseBool(const std::string& text, bool& output);
+bool ParseVec2(const std::string& text, glm::vec2& output);
+bool ParseVec3(const std::string& text, glm::vec3& output);
+bool ParseVec4(const std::string& text, glm::vec4& output);
+bool ParseIVec2(const std::string& text, glm::ivec2& output);
+bool ParseIVec3(const std::string& text, glm::ivec3& output);
+
+// none, uniform_grid, bvh or linear_bvh.
+bool ParseAccelerationType(const std::string& text, AccelerationTypes& output);
+const char* GetAccelerationTypeName(AccelerationTypes type);
+
+// primitives or packed_triangles.
+bool ParseMeshStorageMode(const std::string& text, MeshStorageModes& output);
+const char* GetMeshStorageModeName(MeshStorageModes mode);
+
+}
\ No newline at end of file
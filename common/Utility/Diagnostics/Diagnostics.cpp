@@ -1,8 +1,55 @@
 #include "common/common.h"
 #include "common/Utility/Diagnostics/Diagnostics.h"
+#include "common/Utility/Memory/AlignedAllocator.h"
 
 #if DIAGNOSTICS_ON
 
+namespace
+{
+    const char* const STAT_NAMES[static_cast<int>(DiagnosticsType::MAX)] = {
+        "Ray-Triangle Intersections",
+        "Ray-Box Intersections",
+        "Rays Created",
+        "Shadow Rays",
+        "Photon Queries",
+        "Gather Rays",
+        "BVH Nodes Visited"
+    };
+}
+
+std::atomic<bool> Diagnostics::enabled(true);
+thread_local Diagnostics::StatShard* Diagnostics::threadShard = nullptr;
+
+// Hands the thread's shard back when the thread exits.
+struct ShardReleaser
+{
+    ~ShardReleaser()
+    {
+        if (Diagnostics::threadShard) {
+            Diagnostics::Get()->ReleaseShard(Diagnostics::threadShard);
+            Diagnostics::threadShard = nullptr;
+        }
+    }
+};
+
+Diagnostics::StatShard::StatShard()
+{
+    for (int i = 0; i < static_cast<int>(DiagnosticsType::MAX); ++i) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void* Diagnostics::StatShard::operator new(size_t size)
+{
+    assert(size == sizeof(StatShard));
+    return AlignedAllocator<StatShard, alignof(StatShard)>().allocate(1);
+}
+
+void Diagnostics::StatShard::operator delete(void* memory)
+{
+    AlignedAllocator<StatShard, alignof(StatShard)>().deallocate(static_cast<StatShard*>(memory), 1);
+}
+
 Diagnostics* Diagnostics::Get()
 {
     static std::unique_ptr<Diagnostics> singleton = make_unique<Diagnostics>();
@@ -13,9 +60,47 @@ Diagnostics::Diagnostics()
 {
 }
 
-void Diagnostics::IncrementStat(DiagnosticsType type)
+Diagnostics::StatShard* Diagnostics::AcquireThreadShard()
+{
+    thread_local ShardReleaser releaser;
+    (void)releaser;
+
+    Diagnostics* diagnostics = Get();
+    std::lock_guard<std::mutex> lock(diagnostics->shardMutex);
+    if (!diagnostics->freeShards.empty()) {
+        threadShard = diagnostics->freeShards.back();
+        diagnostics->freeShards.pop_back();
+    } else {
+        diagnostics->shards.emplace_back(make_unique<StatShard>());
+        threadShard = diagnostics->shards.back().get();
+    }
+    return threadShard;
+}
+
+void Diagnostics::ReleaseShard(StatShard* shard)
+{
+    std::lock_guard<std::mutex> lock(shardMutex);
+    freeShards.push_back(shard);
+}
+
+uint64_t Diagnostics::GetStat(DiagnosticsType type) const
+{
+    std::lock_guard<std::mutex> lock(shardMutex);
+    uint64_t total = 0;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        total += shards[i]->counters[static_cast<int>(type)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Diagnostics::Reset()
 {
-    ++statisticsAggregator[type];
+    std::lock_guard<std::mutex> lock(shardMutex);
+    for (size_t i = 0; i < shards.size(); ++i) {
+        for (int s = 0; s < static_cast<int>(DiagnosticsType::MAX); ++s) {
+            shards[i]->counters[s].store(0, std::memory_order_relaxed);
+        }
+    }
 }
 
 void Diagnostics::Log(const std::string& log)
@@ -26,9 +111,9 @@ void Diagnostics::Log(const std::string& log)
 void Diagnostics::Print()
 {
     std::cout << "====================== DIAGNOSTICS START ======================" << std::endl;
-    std::cout << "Ray-Triangle Intersections: " << statisticsAggregator[DiagnosticsType::TRIANGLE_INTERSECTIONS] << std::endl;
-    std::cout << "Ray-Box Intersections: " << statisticsAggregator[DiagnosticsType::BOX_INTERSECTIONS] << std::endl;
-    std::cout << "Rays Created: " << statisticsAggregator[DiagnosticsType::RAYS_CREATED] << std::endl;
+    for (int i = 0; i < static_cast<int>(DiagnosticsType::MAX); ++i) {
+        std::cout << STAT_NAMES[i] << ": " << GetStat(static_cast<DiagnosticsType>(i)) << std::endl;
+    }
     std::cout << "====================== DIAGNOSTICS END ========================" << std::endl;
 }
 
@@ -37,9 +122,9 @@ void Diagnostics::FilePrint(const std::string& fileName)
 	std::fstream fcout;
 	fcout.open(fileName, std::fstream::out | std::fstream::app);
 
-	fcout << "Ray-Triangle Intersections: " << statisticsAggregator[DiagnosticsType::TRIANGLE_INTERSECTIONS] << std::endl;
-	fcout << "Ray-Box Intersections: " << statisticsAggregator[DiagnosticsType::BOX_INTERSECTIONS] << std::endl;
-	fcout << "Rays Created: " << statisticsAggregator[DiagnosticsType::RAYS_CREATED] << std::endl;
+	for (int i = 0; i < static_cast<int>(DiagnosticsType::MAX); ++i) {
+		fcout << STAT_NAMES[i] << ": " << GetStat(static_cast<DiagnosticsType>(i)) << std::endl;
+	}
 	fcout << std::endl;
 }
 
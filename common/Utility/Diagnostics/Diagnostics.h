@@ -1,25 +1,38 @@
 #pragma once
 
+// Build with -DDIAGNOSTICS_ON=0 to compile every statistic and timer out.
+#ifndef DIAGNOSTICS_ON
 #define DIAGNOSTICS_ON 1
+#endif
 
 enum class DiagnosticsType
 {
     TRIANGLE_INTERSECTIONS = 0,
     BOX_INTERSECTIONS,
     RAYS_CREATED,
+    SHADOW_RAYS,
+    PHOTON_QUERIES,
+    GATHER_RAYS,
+    BVH_NODES_VISITED,
     MAX
 };
 
 #if DIAGNOSTICS_ON
-#define DIAGNOSTICS_STAT(t) Diagnostics::Get()->IncrementStat(t)
+#define DIAGNOSTICS_STAT(t) Diagnostics::IncrementStat(t)
+#define DIAGNOSTICS_SET_ENABLED(b) Diagnostics::SetEnabled(b)
 #define DIAGNOSTICS_PRINT() Diagnostics::Get()->Print()
 #define DIAGNOSTICS_FILE_PRINT(fileName) Diagnostics::Get()->FilePrint(fileName)
+#define DIAGNOSTICS_RESET() Diagnostics::Get()->Reset()
 #define DIAGNOSTICS_TIMER(N,D,F) Timer N(D,F)
 #define DIAGNOSTICS_END_TIMER(N) N.Tock()
 #define DIAGNOSTICS_LOG(S) Diagnostics::Get()->Log(S)
 
+#include <atomic>
 #include <memory>
-#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
 
 class Diagnostics
 {
@@ -28,19 +41,60 @@ public:
 
     static Diagnostics* Get();
 
-    void IncrementStat(DiagnosticsType type);
+    // Each thread counts into its own cache line; the shards are only summed when the statistics are read.
+    static void IncrementStat(DiagnosticsType type)
+    {
+        if (!enabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        StatShard* shard = threadShard ? threadShard : AcquireThreadShard();
+        std::atomic<uint64_t>& counter = shard->counters[static_cast<int>(type)];
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Counting is on by default. Turning it off leaves a single relaxed load per statistic.
+    static void SetEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    uint64_t GetStat(DiagnosticsType type) const;
+    void Reset();
+
     void Print();
 	void FilePrint(const std::string& fileName = "log.txt");
     void Log(const std::string& log);
 private:
+    struct alignas(64) StatShard
+    {
+        StatShard();
+
+        // Plain new only guarantees 16-byte alignment before C++17.
+        static void* operator new(size_t size);
+        static void operator delete(void* memory);
+
+        std::atomic<uint64_t> counters[static_cast<int>(DiagnosticsType::MAX)];
+    };
+
+    static StatShard* AcquireThreadShard();
+    void ReleaseShard(StatShard* shard);
+
+    static std::atomic<bool> enabled;
+    static thread_local StatShard* threadShard;
+
+    // Shards outlive their threads so nothing counted is lost; a finished thread's shard is reused by the next one.
+    mutable std::mutex shardMutex;
+    std::vector<std::unique_ptr<StatShard>> shards;
+    std::vector<StatShard*> freeShards;
 
-    std::map<DiagnosticsType, int> statisticsAggregator;
+    friend struct ShardReleaser;
 };
 
 #else
 #define DIAGNOSTICS_STAT(t)
-#define DIAGNOSTICS_PRINT
-#define DIAGNOSTICS_TIMER(N,D)
+#define DIAGNOSTICS_SET_ENABLED(b)
+#define DIAGNOSTICS_PRINT()
+#define DIAGNOSTICS_FILE_PRINT(fileName)
+#define DIAGNOSTICS_RESET()
+#define DIAGNOSTICS_TIMER(N,D,F)
 #define DIAGNOSTICS_END_TIMER(N)
 #define DIAGNOSTICS_LOG(S)
 #endif
\ No newline at end of file
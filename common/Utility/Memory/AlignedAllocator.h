@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Minimal allocator that hands out memory aligned to Alignment bytes. Needed because std::vector does not respect
+// over-aligned types until C++17, and we want node/packet arrays that start on a cache line or SIMD boundary.
+template<typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() {}
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t count)
+    {
+        void* memory = nullptr;
+#ifdef _WIN32
+        memory = _aligned_malloc(count * sizeof(T), Alignment);
+#else
+        if (posix_memalign(&memory, Alignment, count * sizeof(T)) != 0) {
+            memory = nullptr;
+        }
+#endif
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* memory, size_t)
+    {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        free(memory);
+#endif
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
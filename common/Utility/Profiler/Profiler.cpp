@@ -0,0 +1,218 @@
+#include "common/common.h"
+#include "common/Utility/Profiler/Profiler.h"
+#include <chrono>
+#include <iomanip>
+#include <map>
+
+#if PROFILER_ON
+
+namespace
+{
+    const std::chrono::steady_clock::time_point profilerEpoch = std::chrono::steady_clock::now();
+
+    void WriteJSONString(std::ostream& output, const char* text)
+    {
+        output << '"';
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                output << '\\';
+            }
+            output << *c;
+        }
+        output << '"';
+    }
+}
+
+std::atomic<bool> Profiler::enabled(false);
+thread_local Profiler::ThreadBuffer* Profiler::threadBuffer = nullptr;
+
+// Hands the thread's buffer back when the thread exits.
+struct ProfilerBufferReleaser
+{
+    ~ProfilerBufferReleaser()
+    {
+        if (Profiler::threadBuffer) {
+            Profiler::Get()->ReleaseBuffer(Profiler::threadBuffer);
+            Profiler::threadBuffer = nullptr;
+        }
+    }
+};
+
+Profiler::ThreadBuffer::ThreadBuffer(size_t capacity, int inputLane):
+    events(capacity), eventsWritten(0), lane(inputLane), depth(0)
+{
+}
+
+Profiler* Profiler::Get()
+{
+    static std::unique_ptr<Profiler> singleton(new Profiler());
+    return singleton.get();
+}
+
+Profiler::Profiler():
+    eventsPerThread(1 << 16)
+{
+}
+
+uint64_t Profiler::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerEpoch).count());
+}
+
+void Profiler::SetEventsPerThread(size_t count)
+{
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    eventsPerThread = std::max<size_t>(count, 1);
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer()
+{
+    return threadBuffer ? threadBuffer : AcquireThreadBuffer();
+}
+
+Profiler::ThreadBuffer* Profiler::AcquireThreadBuffer()
+{
+    thread_local ProfilerBufferReleaser releaser;
+    (void)releaser;
+
+    Profiler* profiler = Get();
+    std::lock_guard<std::mutex> lock(profiler->bufferMutex);
+    if (!profiler->freeBuffers.empty()) {
+        threadBuffer = profiler->freeBuffers.back();
+        profiler->freeBuffers.pop_back();
+    } else {
+        profiler->buffers.emplace_back(make_unique<ThreadBuffer>(profiler->eventsPerThread, static_cast<int>(profiler->buffers.size())));
+        threadBuffer = profiler->buffers.back().get();
+    }
+    return threadBuffer;
+}
+
+void Profiler::ReleaseBuffer(ThreadBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    freeBuffers.push_back(buffer);
+}
+
+void Profiler::Reset()
+{
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        buffers[i]->eventsWritten.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::vector<Profiler::Event> Profiler::CollectEvents(const ThreadBuffer& buffer) const
+{
+    // Oldest first; once the ring has wrapped only the newest events are left.
+    const uint64_t written = buffer.eventsWritten.load(std::memory_order_acquire);
+    const uint64_t capacity = buffer.events.size();
+    const uint64_t first = (written > capacity) ? written - capacity : 0;
+
+    std::vector<Event> output;
+    output.reserve(static_cast<size_t>(written - first));
+    for (uint64_t i = first; i < written; ++i) {
+        output.push_back(buffer.events[static_cast<size_t>(i % capacity)]);
+    }
+    return output;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& fileName) const
+{
+    std::ofstream output(fileName);
+    if (!output) {
+        std::cerr << "WARNING: Could not write the profile to " << fileName << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    output << "{\"traceEvents\":[" << std::endl;
+    output << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (size_t b = 0; b < buffers.size(); ++b) {
+        const std::vector<Event> events = CollectEvents(*buffers[b]);
+        for (size_t i = 0; i < events.size(); ++i) {
+            output << (first ? "" : ",\n") << "{\"name\":";
+            WriteJSONString(output, events[i].name);
+            output << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffers[b]->lane
+                   << ",\"ts\":" << events[i].startTime / 1000.0 << ",\"dur\":" << events[i].duration / 1000.0 << "}";
+            first = false;
+        }
+    }
+    output << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    return true;
+}
+
+void Profiler::PrintSummary(std::ostream& output) const
+{
+    struct ZoneTotals
+    {
+        uint64_t calls = 0;
+        uint64_t total = 0;
+        uint64_t self = 0;
+        uint64_t longest = 0;
+    };
+
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    std::map<std::string, ZoneTotals> zones;
+    std::vector<uint64_t> threadBusyTime(buffers.size(), 0);
+    for (size_t b = 0; b < buffers.size(); ++b) {
+        const std::vector<Event> events = CollectEvents(*buffers[b]);
+        for (size_t i = 0; i < events.size(); ++i) {
+            ZoneTotals& zone = zones[events[i].name];
+            ++zone.calls;
+            zone.total += events[i].duration;
+            zone.self += events[i].selfDuration;
+            zone.longest = std::max(zone.longest, events[i].duration);
+            if (events[i].depth == 0) {
+                threadBusyTime[b] += events[i].duration;
+            }
+        }
+    }
+
+    const double toMilliseconds = 1e-6;
+    output << "====================== PROFILE START ==========================" << std::endl;
+    output << std::left << std::setw(32) << "Zone" << std::right << std::setw(10) << "Calls" << std::setw(14) << "Total ms"
+           << std::setw(14) << "Self ms" << std::setw(14) << "Longest ms" << std::endl;
+    output << std::fixed << std::setprecision(3);
+    for (const auto& zone : zones) {
+        output << std::left << std::setw(32) << zone.first << std::right << std::setw(10) << zone.second.calls
+               << std::setw(14) << zone.second.total * toMilliseconds << std::setw(14) << zone.second.self * toMilliseconds
+               << std::setw(14) << zone.second.longest * toMilliseconds << std::endl;
+    }
+    for (size_t b = 0; b < threadBusyTime.size(); ++b) {
+        output << "Thread " << buffers[b]->lane << " busy: " << threadBusyTime[b] * toMilliseconds << " ms" << std::endl;
+    }
+    output << "====================== PROFILE END ============================" << std::endl;
+    output.unsetf(std::ios_base::floatfield);
+}
+
+void ScopedProfileZone::Begin()
+{
+    buffer = Profiler::GetThreadBuffer();
+    if (buffer->depth >= Profiler::ThreadBuffer::MAX_ZONE_DEPTH) {
+        buffer = nullptr;
+        return;
+    }
+    buffer->childDuration[buffer->depth++] = 0;
+    startTime = Profiler::Now();
+}
+
+void ScopedProfileZone::End()
+{
+    const uint64_t duration = Profiler::Now() - startTime;
+    const int depth = --buffer->depth;
+    if (depth > 0) {
+        buffer->childDuration[depth - 1] += duration;
+    }
+
+    const uint64_t written = buffer->eventsWritten.load(std::memory_order_relaxed);
+    Profiler::Event& event = buffer->events[static_cast<size_t>(written % buffer->events.size())];
+    event.name = name;
+    event.startTime = startTime;
+    event.duration = duration;
+    event.selfDuration = duration - buffer->childDuration[depth];
+    event.depth = depth;
+    buffer->eventsWritten.store(written + 1, std::memory_order_release);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+// Build with -DPROFILER_ON=0 to compile every zone out.
+#ifndef PROFILER_ON
+#define PROFILER_ON 1
+#endif
+
+#define PROFILER_CONCAT_HELPER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_HELPER(a, b)
+
+#if PROFILER_ON
+// Times the enclosing scope. The name must outlive the profiler -- use a string literal.
+#define PROFILE_ZONE(name) ScopedProfileZone PROFILER_CONCAT(profileZone, __LINE__)(name)
+#define PROFILER_SET_ENABLED(b) Profiler::SetEnabled(b)
+#define PROFILER_PRINT_SUMMARY(output) Profiler::Get()->PrintSummary(output)
+#define PROFILER_WRITE_TRACE(fileName) Profiler::Get()->WriteChromeTrace(fileName)
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class Profiler
+{
+public:
+    struct Event
+    {
+        const char* name;
+        uint64_t startTime;     // Nanoseconds since the profiler was created.
+        uint64_t duration;
+        uint64_t selfDuration;  // Duration minus the time spent in nested zones.
+        int depth;
+    };
+
+    static Profiler* Get();
+
+    // Recording is off until enabled; a disabled zone costs one relaxed load.
+    static void SetEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Events each thread keeps before the oldest are overwritten. Applies to threads that start recording afterwards.
+    void SetEventsPerThread(size_t count);
+
+    void Reset();
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto). One lane per recording thread.
+    bool WriteChromeTrace(const std::string& fileName) const;
+
+    // Per-zone totals followed by the busy time of each thread.
+    void PrintSummary(std::ostream& output) const;
+
+    static uint64_t Now();
+
+private:
+    friend class ScopedProfileZone;
+    friend struct ProfilerBufferReleaser;
+
+    struct ThreadBuffer
+    {
+        // Zones nested deeper than this are not recorded.
+        static const int MAX_ZONE_DEPTH = 64;
+
+        explicit ThreadBuffer(size_t capacity, int lane);
+
+        std::vector<Event> events;
+        std::atomic<uint64_t> eventsWritten;
+        int lane;
+
+        // Open zone bookkeeping, only touched by the owning thread.
+        int depth;
+        uint64_t childDuration[MAX_ZONE_DEPTH];
+    };
+
+    Profiler();
+
+    static ThreadBuffer* GetThreadBuffer();
+    static ThreadBuffer* AcquireThreadBuffer();
+    void ReleaseBuffer(ThreadBuffer* buffer);
+    std::vector<Event> CollectEvents(const ThreadBuffer& buffer) const;
+
+    static std::atomic<bool> enabled;
+    static thread_local ThreadBuffer* threadBuffer;
+
+    // Buffers outlive their threads; a finished thread's buffer (and lane) goes to the next thread that records.
+    mutable std::mutex bufferMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> freeBuffers;
+    size_t eventsPerThread;
+};
+
+class ScopedProfileZone
+{
+public:
+    explicit ScopedProfileZone(const char* zoneName):
+        name(zoneName), buffer(nullptr), startTime(0)
+    {
+        if (Profiler::IsEnabled()) {
+            Begin();
+        }
+    }
+
+    ~ScopedProfileZone()
+    {
+        if (buffer) {
+            End();
+        }
+    }
+
+    ScopedProfileZone(const ScopedProfileZone&) = delete;
+    ScopedProfileZone& operator=(const ScopedProfileZone&) = delete;
+
+private:
+    void Begin();
+    void End();
+
+    const char* name;
+    Profiler::ThreadBuffer* buffer;
+    uint64_t startTime;
+};
+
+#else
+#define PROFILE_ZONE(name)
+#define PROFILER_SET_ENABLED(b)
+#define PROFILER_PRINT_SUMMARY(output)
+#define PROFILER_WRITE_TRACE(fileName)
+#endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Lets any number of readers in at once, or a single writer. C++11 has no std::shared_mutex, so this is a small
+// spinning stand-in with the same member names; it is meant for structures that are read far more often than they
+// are written, where a plain mutex would serialise the readers. A waiting writer keeps new readers out, so a steady
+// stream of readers cannot starve it.
+class ReaderWriterLock
+{
+public:
+    ReaderWriterLock(): state(0) {}
+
+    ReaderWriterLock(const ReaderWriterLock&) = delete;
+    ReaderWriterLock& operator=(const ReaderWriterLock&) = delete;
+
+    void lock_shared()
+    {
+        unsigned int current = state.load(std::memory_order_relaxed);
+        for (;;) {
+            if (current & WRITER_BIT) {
+                std::this_thread::yield();
+                current = state.load(std::memory_order_relaxed);
+            } else if (state.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    void unlock_shared()
+    {
+        state.fetch_sub(1, std::memory_order_release);
+    }
+
+    void lock()
+    {
+        writerMutex.lock();
+        state.fetch_or(WRITER_BIT, std::memory_order_acquire);
+        while (state.load(std::memory_order_acquire) != WRITER_BIT) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock()
+    {
+        state.fetch_and(~WRITER_BIT, std::memory_order_release);
+        writerMutex.unlock();
+    }
+
+private:
+    static const unsigned int WRITER_BIT = 1u << 31;
+
+    // Reader count in the low bits, WRITER_BIT while a writer holds or waits for the lock.
+    std::atomic<unsigned int> state;
+    // Only one writer at a time may own WRITER_BIT.
+    std::mutex writerMutex;
+};
+
+// std::lock_guard for the shared side of a ReaderWriterLock.
+class SharedLockGuard
+{
+public:
+    explicit SharedLockGuard(ReaderWriterLock& inputLock): lock(inputLock)
+    {
+        lock.lock_shared();
+    }
+
+    ~SharedLockGuard()
+    {
+        lock.unlock_shared();
+    }
+
+    SharedLockGuard(const SharedLockGuard&) = delete;
+    SharedLockGuard& operator=(const SharedLockGuard&) = delete;
+
+private:
+    ReaderWriterLock& lock;
+};
\ No newline at end of file
@@ -1,19 +1,10 @@
 #include "common/RayTracer.h"
-
-#define ASSIGNMENT 8
-#if ASSIGNMENT == 5
-#define APPLICATION Assignment5
+#include "common/SceneFileApplication.h"
+#include "common/Utility/Config/ConfigParsing.h"
 #include "assignment5/Assignment5.h"
-#elif ASSIGNMENT == 6
-#define APPLICATION Assignment6
 #include "assignment6/Assignment6.h"
-#elif ASSIGNMENT == 7
-#define APPLICATION Assignment7
 #include "assignment7/Assignment7.h"
-#elif ASSIGNMENT == 8
-#define APPLICATION Assignment8
 #include "assignment8/Assignment8.h"
-#endif
 
 #ifdef _WIN32
 #define WAIT_ON_EXIT 1
@@ -21,65 +12,328 @@
 #define WAIT_ON_EXIT 0
 #endif
 
-int main(int argc, char** argv)  
+namespace
+{
+typedef std::vector<std::pair<std::string, std::string>> SettingList;
+
+// One render: a scene file, or one of the assignments when the file is empty.
+struct RenderJob
+{
+	std::string sceneFile;
+	int assignment;
+	SettingList settings;
+};
+
+struct RunOptions
+{
+	std::string logFile;
+	std::string profileFile;
+	std::vector<std::string> jobFiles;
+};
+
+// What main.cpp used to hard-code; the assignments start from these before the command line is applied.
+const char* const ASSIGNMENT_DEFAULTS[][2] = {
+	{ "resolution", "600 450" },
+	{ "spp", "1" },
+	{ "min_spp", "1" },
+	{ "adaptive_coef", "10" },
+	{ "grid", "1 1 1" },
+	{ "adaptive", "off" },
+	{ "output", "New scene/Sphere 300K 500K.png" },
+	{ "max_reflection_bounces", "2" },
+	{ "max_refraction_bounces", "3" },
+	{ "acceleration", "uniform_grid" },
+	{ "tile_size", "16 16" },
+	{ "mesh_storage", "primitives" }
+};
+
+void PrintUsage(const char* program)
+{
+	std::cout << "Usage: " << program << " [options] [scene files...]" << std::endl
+		<< "Renders every scene file in turn, or assignment 8 if there is nothing else to do." << std::endl
+		<< "  --assignment <5-8>     render one of the assignment scenes" << std::endl
+		<< "  --jobs <file>          one job per line: a scene file or --assignment, then its own settings" << std::endl
+		<< "  --log <file>           statistics log, appended to (default \"New scene/Stat.txt\")" << std::endl
+		<< "  --profile <file>       Chrome trace of the whole run (default \"New scene/Profile.json\")" << std::endl
+		<< "  --<setting> <value>    any scene file setting, e.g. --spp 16 --resolution 800,600 --renderer photon" << std::endl
+		<< "  --set <setting>=<value>" << std::endl
+		<< "Settings on the command line apply to every job and override the scene files; settings on a line" << std::endl
+		<< "of a jobs file override both." << std::endl;
+}
+
+// Reads scene files, --assignment and settings from the arguments. Run options are only accepted when options is
+// not null, i.e. on the command line itself but not in a jobs file.
+bool ParseJobArguments(const std::vector<std::string>& arguments, RunOptions* options, SettingList& settings, std::vector<RenderJob>& jobs)
+{
+	for (size_t i = 0; i < arguments.size(); ++i)
+	{
+		const std::string& argument = arguments[i];
+		if (argument.size() < 3 || argument.compare(0, 2, "--") != 0)
+		{
+			RenderJob job;
+			job.sceneFile = argument;
+			job.assignment = 0;
+			jobs.push_back(job);
+			continue;
+		}
+
+		if (i + 1 >= arguments.size())
+		{
+			std::cerr << "ERROR: " << argument << " needs a value." << std::endl;
+			return false;
+		}
+		std::string name = argument.substr(2);
+		std::replace(name.begin(), name.end(), '-', '_');
+		const std::string& value = arguments[++i];
+
+		if (name == "assignment")
+		{
+			RenderJob job;
+			if (!ConfigParsing::ParseInt(value, job.assignment))
+			{
+				std::cerr << "ERROR: Invalid assignment number " << value << std::endl;
+				return false;
+			}
+			jobs.push_back(job);
+		}
+		else if (name == "set")
+		{
+			const size_t separator = value.find('=');
+			if (separator == std::string::npos)
+			{
+				std::cerr << "ERROR: Expected --set <setting>=<value>, got " << value << std::endl;
+				return false;
+			}
+			settings.push_back(std::make_pair(value.substr(0, separator), value.substr(separator + 1)));
+		}
+		else if (options && name == "log")
+		{
+			options->logFile = value;
+		}
+		else if (options && name == "profile")
+		{
+			options->profileFile = value;
+		}
+		else if (options && name == "jobs")
+		{
+			options->jobFiles.push_back(value);
+		}
+		else
+		{
+			settings.push_back(std::make_pair(name, value));
+		}
+	}
+	return true;
+}
+
+bool ReadJobFile(const std::string& fileName, const SettingList& sharedSettings, std::vector<RenderJob>& jobs)
+{
+	std::ifstream file(fileName);
+	if (!file)
+	{
+		std::cerr << "ERROR: Could not open the jobs file " << fileName << std::endl;
+		return false;
+	}
+
+	bool success = true;
+	std::string line;
+	std::vector<std::string> tokens;
+	for (int lineNumber = 1; std::getline(file, line); ++lineNumber)
+	{
+		SettingList lineSettings;
+		std::vector<RenderJob> lineJobs;
+		if (!ConfigParsing::Tokenize(line, tokens) || !ParseJobArguments(tokens, nullptr, lineSettings, lineJobs))
+		{
+			std::cerr << "ERROR: " << fileName << ":" << lineNumber << ": could not read the job." << std::endl;
+			success = false;
+			continue;
+		}
+		if (lineJobs.empty() && !lineSettings.empty())
+		{
+			std::cerr << "ERROR: " << fileName << ":" << lineNumber << ": settings without a scene file or --assignment." << std::endl;
+			success = false;
+			continue;
+		}
+
+		for (RenderJob& job : lineJobs)
+		{
+			job.settings = sharedSettings;
+			job.settings.insert(job.settings.end(), lineSettings.begin(), lineSettings.end());
+			jobs.push_back(job);
+		}
+	}
+	return success;
+}
+
+// Builds the application for a job and applies its settings, so that every job is checked before anything renders.
+std::unique_ptr<Application> PrepareJob(const RenderJob& job)
+{
+	std::unique_ptr<Application> application;
+	if (job.sceneFile.empty())
+	{
+		switch (job.assignment)
+		{
+		case 5:
+			application = make_unique<Assignment5>();
+			break;
+		case 6:
+			application = make_unique<Assignment6>();
+			break;
+		case 7:
+			application = make_unique<Assignment7>();
+			break;
+		case 8:
+			application = make_unique<Assignment8>();
+			break;
+		default:
+			std::cerr << "ERROR: There is no assignment " << job.assignment << "." << std::endl;
+			return nullptr;
+		}
+
+		for (const auto& setting : ASSIGNMENT_DEFAULTS)
+		{
+			application->ApplySetting(setting[0], setting[1]);
+		}
+	}
+	else
+	{
+		std::unique_ptr<SceneFileApplication> sceneApplication = make_unique<SceneFileApplication>();
+		if (!sceneApplication->LoadSceneFile(job.sceneFile))
+		{
+			return nullptr;
+		}
+		application = std::move(sceneApplication);
+	}
+
+	for (const auto& setting : job.settings)
+	{
+		if (!application->ApplySetting(setting.first, setting.second))
+		{
+			std::cerr << "ERROR: Invalid setting " << setting.first << " = \"" << setting.second << "\"" << std::endl;
+			return nullptr;
+		}
+	}
+	return application;
+}
+
+std::string GetJobName(const RenderJob& job)
 {
-    std::unique_ptr<APPLICATION> currentApplication = make_unique<APPLICATION>();
-	currentApplication->SetImageOutputResolution(glm::vec2(600, 450)); // (glm::vec2(1600, 1200)) (1280, 960) (1024, 768)
-	currentApplication->SetSamplesPerPixel(1);
-	currentApplication->SetMinSamplesPerPixel(1);
-	currentApplication->SetAdaptiveCoef(10.f);
-	currentApplication->SetGridSize(glm::ivec3(1, 1, 1));
-	currentApplication->SetUseAdaptiveSampler(false);
-	currentApplication->SetOutputFilename("New scene/Sphere 300K 500K.png"); 
-	// Assignment8/Gather/ // Gather 300000 0.02 150f 24 gather samples nodirect fix
-	// "RT + FM/Caustic + RT 64 GS 0.02 0.01r IOR 1.3 scale 0.3.png"
-	currentApplication->SetMaxReflectionBounces(2);
-	currentApplication->SetMaxRefractionBounces(3);
-	currentApplication->SetAcceleratingStructureType(1);
-
-	const std::string logFile = "New scene/Stat.txt"; // Assignment8/Gather/
+	return job.sceneFile.empty() ? "Assignment " + std::to_string(job.assignment) : job.sceneFile;
+}
 
+bool RunRenderJob(const std::string& jobName, std::unique_ptr<Application> currentApplication, const std::string& logFile)
+{
 	std::fstream fcout;
 	fcout.open(logFile, std::fstream::out | std::fstream::app);
+	fcout << "Scene " << jobName << std::endl;
+	fcout << "Output " << currentApplication->GetOutputFilename() << std::endl;
 	fcout << "Samples per pixel " << currentApplication->GetSamplesPerPixel() << std::endl;
 	fcout << "Min samples per pixel " << currentApplication->GetMinSamplesPerPixel() << std::endl;
 	fcout << "Max reflections bounces " << currentApplication->GetMaxReflectionBounces() << std::endl;
 	fcout << "Max refraction bounces " << currentApplication->GetMaxRefractionBounces() << std::endl;
-	fcout << "Acceleration structure ";
-	switch (static_cast<int>(currentApplication->GetAcceleratingStructureType()))
-	{
-	case 0:
-		fcout << "NONE";
-		break;
-	case 1:
-		fcout << "UNIFORM_GRID";
-		break;
-	case 2:
-		fcout << "BVH";
-		break;
-	default:
-		fcout << "Unknown type";
-		break;
-	} 
-	fcout << std::endl;
-	fcout << "Threads number " << numThreads << std::endl;
-
-    RayTracer rayTracer(std::move(currentApplication));
+	fcout << "Acceleration structure " << ConfigParsing::GetAccelerationTypeName(currentApplication->GetAcceleratingStructureType()) << std::endl;
+	fcout << "Mesh storage " << ConfigParsing::GetMeshStorageModeName(currentApplication->GetMeshStorageMode()) << std::endl;
+	fcout << "Threads number " << currentApplication->GetNumThreads() << std::endl;
+
+	std::cout << "Rendering " << jobName << " to " << currentApplication->GetOutputFilename() << std::endl;
+	RayTracer rayTracer(std::move(currentApplication));
 
 	DIAGNOSTICS_TIMER(timer, "Initialization", logFile);
-	rayTracer.Init();
+	const bool initialized = rayTracer.Init();
 	DIAGNOSTICS_END_TIMER(timer);
+	if (!initialized)
+	{
+		std::cerr << "ERROR: Could not set up the scene of " << jobName << "; it was not rendered." << std::endl;
+		DIAGNOSTICS_RESET();
+		return false;
+	}
+
 	DIAGNOSTICS_TIMER(timer2, "Ray Tracer", logFile);
-    rayTracer.Run();
-    DIAGNOSTICS_END_TIMER(timer2);
+	rayTracer.Run();
+	DIAGNOSTICS_END_TIMER(timer2);
+	rayTracer.PrintRenderStatistics(fcout, true);
 
-    DIAGNOSTICS_PRINT();
+	DIAGNOSTICS_PRINT();
 	DIAGNOSTICS_FILE_PRINT(logFile);
+	DIAGNOSTICS_RESET();
+	return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+	RunOptions options;
+	options.logFile = "New scene/Stat.txt";
+	options.profileFile = "New scene/Profile.json"; // Open in chrome://tracing
+
+	const std::vector<std::string> arguments(argv + 1, argv + argc);
+	for (const std::string& argument : arguments)
+	{
+		if (argument == "--help" || argument == "-h")
+		{
+			PrintUsage(argv[0]);
+			return 0;
+		}
+	}
+
+	SettingList sharedSettings;
+	std::vector<RenderJob> jobs;
+	if (!ParseJobArguments(arguments, &options, sharedSettings, jobs))
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+	for (RenderJob& job : jobs)
+	{
+		job.settings = sharedSettings;
+	}
+
+	bool jobFilesRead = true;
+	for (const std::string& jobFile : options.jobFiles)
+	{
+		jobFilesRead = ReadJobFile(jobFile, sharedSettings, jobs) && jobFilesRead;
+	}
+	if (!jobFilesRead)
+	{
+		return 1;
+	}
+
+	if (jobs.empty() && options.jobFiles.empty())
+	{
+		RenderJob job;
+		job.assignment = 8;
+		job.settings = sharedSettings;
+		jobs.push_back(job);
+	}
+
+	std::vector<std::unique_ptr<Application>> applications;
+	for (const RenderJob& job : jobs)
+	{
+		applications.push_back(PrepareJob(job));
+		if (!applications.back())
+		{
+			std::cerr << "ERROR: Could not set up " << GetJobName(job) << "; nothing was rendered." << std::endl;
+			return 1;
+		}
+	}
+
+	PROFILER_SET_ENABLED(true);
+	bool allRendered = true;
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		allRendered = RunRenderJob(GetJobName(jobs[i]), std::move(applications[i]), options.logFile) && allRendered;
+	}
+
+	std::fstream fcout;
+	fcout.open(options.logFile, std::fstream::out | std::fstream::app);
+	PROFILER_PRINT_SUMMARY(std::cout);
+	PROFILER_PRINT_SUMMARY(fcout);
+	PROFILER_WRITE_TRACE(options.profileFile);
 
 #if defined(_WIN32) && WAIT_ON_EXIT
     int exit = 0;
     std::cin >> exit;
 #endif
 
-    return 0;
+    return allRendered ? 0 : 1;
 }
\ No newline at end of file